@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "devices/ide.h"
+#include "threads/trace.h"
 #include "threads/malloc.h"
 
 /* A block device. */
@@ -121,6 +122,7 @@ void
 block_read (struct block *block, block_sector_t sector, void *buffer)
 {
   check_sector (block, sector);
+  TRACE (TRACE_BLOCK_READ, sector, block->type, 0);
   block->ops->read (block->aux, sector, buffer);
   block->read_cnt++;
 }
@@ -135,6 +137,7 @@ block_write (struct block *block, block_sector_t sector, const void *buffer)
 {
   check_sector (block, sector);
   ASSERT (block->type != BLOCK_FOREIGN);
+  TRACE (TRACE_BLOCK_WRITE, sector, block->type, 0);
   block->ops->write (block->aux, sector, buffer);
   block->write_cnt++;
 }
@@ -92,7 +92,9 @@ wait (struct intq *q UNUSED, struct thread **waiter)
           || (waiter == &q->not_full && intq_full (q)));
 
   *waiter = thread_current ();
+  thread_current ()->wait = WAIT_IO;
   thread_block ();
+  thread_current ()->wait = WAIT_OTHER;
 }
 
 /* WAITER must be the address of Q's not_empty or not_full
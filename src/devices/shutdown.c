@@ -4,7 +4,13 @@
 #include "devices/kbd.h"
 #include "devices/serial.h"
 #include "devices/timer.h"
+#include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/palloc.h"
+#include "threads/profile.h"
+#include "threads/slab.h"
+#include "threads/trace.h"
+#include "threads/synch.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
@@ -130,6 +136,16 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+  kmem_print_stats ();
+  palloc_print_stats ();
+  if (lockstat_enabled)
+    lockstat_print (LOCKSTAT_TOP);
+  if (intrstat_enabled)
+    intrstat_print ();
+  if (profile_running ())
+    profile_print ();
+  if (trace_mask != 0)
+    trace_dump ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
@@ -4,9 +4,12 @@
 #include <round.h>
 #include <stdio.h>
 #include "devices/pit.h"
+#include "devices/timerq.h"
 #include "threads/interrupt.h"
+#include "threads/profile.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "threads/tsc.h"
   
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -20,30 +23,53 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* PIT cycles per timer tick. */
+#define CYCLES_PER_TICK (PIT_HZ / TIMER_FREQ)
+
+/* Longest one-shot the 16-bit PIT counter can time, in ticks. */
+#define ONESHOT_MAX_TICKS (UINT16_MAX / CYCLES_PER_TICK)
+
+/* See timer.h. */
+bool timer_tickless;
+
+/* Number of ticks covered by the pending one-shot, or 0 if the
+   PIT is in periodic mode. */
+static int64_t oneshot_ticks;
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Number of TSC cycles per timer tick, measured over
+   TSC_CALIBRATE_TICKS ticks.  Initialized by timer_calibrate(). */
+#define TSC_CALIBRATE_TICKS 4
+static uint64_t tsc_per_tick;
+
 static intr_handler_func timer_interrupt;
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
 static void real_time_delay (int64_t num, int32_t denom);
+static void timer_advance (int64_t cnt);
 
 /* Sets up the timer to interrupt TIMER_FREQ times per second,
    and registers the corresponding interrupt. */
 void
 timer_init (void) 
 {
+  timerq_init ();
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Calibrates loops_per_tick, used to implement brief delays,
+   and tsc_per_tick, used to convert TSC cycles to time. */
 void
 timer_calibrate (void) 
 {
   unsigned high_bit, test_bit;
+  int64_t start;
+  uint64_t tsc;
 
   ASSERT (intr_get_level () == INTR_ON);
   printf ("Calibrating timer...  ");
@@ -63,9 +89,34 @@ timer_calibrate (void)
     if (!too_many_loops (loops_per_tick | test_bit))
       loops_per_tick |= test_bit;
 
+  /* Count TSC cycles from one tick to a later one. */
+  start = ticks;
+  while (ticks == start)
+    barrier ();
+  tsc = rdtsc ();
+  start = ticks;
+  while (ticks < start + TSC_CALIBRATE_TICKS)
+    barrier ();
+  tsc_per_tick = (rdtsc () - tsc) / TSC_CALIBRATE_TICKS;
+
   printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
 }
 
+/* Converts CYCLES of the TSC to nanoseconds.  Returns 0 before
+   timer_calibrate() has run. */
+uint64_t
+timer_cycles_to_ns (uint64_t cycles)
+{
+  uint64_t tsc_hz = tsc_per_tick * TIMER_FREQ;
+
+  if (tsc_hz == 0)
+    return 0;
+
+  /* Split the multiplication to avoid overflow. */
+  return (cycles / tsc_hz * 1000000000
+          + cycles % tsc_hz * 1000000000 / tsc_hz);
+}
+
 /* Returns the number of timer ticks since the OS booted. */
 int64_t
 timer_ticks (void) 
@@ -166,31 +217,116 @@ timer_print_stats (void)
   printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
 }
 
+/* Called by the idle thread, with interrupts off, just before
+   it halts the CPU.  In dynamic tick mode, stops the periodic
+   tick and instead arms a one-shot interrupt for the next timer
+   deadline, or for as far ahead as the PIT can count if that is
+   sooner. */
+void
+timer_idle_enter (void) 
+{
+  int64_t delta;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!timer_tickless || oneshot_ticks != 0)
+    return;
+
+  delta = timerq_next_expiry () - ticks;
+  if (delta <= 1)
+    return;
+  if (delta > ONESHOT_MAX_TICKS)
+    delta = ONESHOT_MAX_TICKS;
+
+  oneshot_ticks = delta;
+  pit_start_oneshot (0, delta * CYCLES_PER_TICK);
+}
+
+/* Called with interrupts off by the idle thread after the CPU
+   wakes up, and by thread_unblock() when an interrupt handler
+   wakes a thread while the idle thread is running.  If an
+   interrupt other than the timer's ended the halt, credits the
+   whole ticks that passed in the meantime and restores the
+   periodic tick, so that a thread made runnable by that
+   interrupt sees an up-to-date clock and is preempted on time.
+   Any partial tick is dropped.  Does nothing if the PIT is
+   already in periodic mode. */
+void
+timer_idle_exit (void) 
+{
+  int64_t elapsed;
+  uint16_t count;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (oneshot_ticks == 0)
+    return;
+
+  count = pit_read_count (0);
+  if (count == 0 || count > oneshot_ticks * CYCLES_PER_TICK)
+    {
+      /* The counter already reached zero and wrapped around, so
+         its interrupt is pending and will account for the last
+         tick. */
+      elapsed = oneshot_ticks - 1;
+    }
+  else
+    elapsed = (oneshot_ticks * CYCLES_PER_TICK - count) / CYCLES_PER_TICK;
+
+  oneshot_ticks = 0;
+  pit_configure_channel (0, 2, TIMER_FREQ);
+  timer_advance (elapsed);
+}
+
 /* Timer interrupt handler. */
 static void
-timer_interrupt (struct intr_frame *args UNUSED)
+timer_interrupt (struct intr_frame *args)
 {
-  ticks++;
-  thread_tick ();
-
-  if (thread_mlfqs) 
-  {
-    increase_recent_cpu();
-  }
-
-  if (thread_mlfqs && (ticks % TIMER_FREQ == 0)) // Update the priority of all threads every 'second' (100 ticks)
-  { 
-      calc_load_avg(); //load_avg 계산
-      recent_cpu_update(); //recent_cpu 업데이트
-  }
-
-  if (thread_mlfqs && (ticks % 4 == 0)) // Update the current thread's priority every 4 ticks
-  { 
-      MLFQS_priority_update(); 
-  }
-
-  /*For task 1. alarm clock*/
-  thread_wakeup(ticks); 
+  int64_t cnt = 1;
+
+  profile_interrupt (args);
+
+  if (oneshot_ticks != 0)
+    {
+      /* The one-shot armed by timer_idle_enter() expired.  Go back
+         to periodic mode and catch up on the ticks it covered. */
+      cnt = oneshot_ticks;
+      oneshot_ticks = 0;
+      pit_configure_channel (0, 2, TIMER_FREQ);
+    }
+
+  timer_advance (cnt);
+}
+
+/* Advances the tick count by CNT ticks, doing each tick's
+   scheduler bookkeeping and expiring kernel timers. */
+static void
+timer_advance (int64_t cnt)
+{
+  while (cnt-- > 0)
+    {
+      ticks++;
+      thread_tick ();
+
+      if (thread_mlfqs) 
+      {
+        increase_recent_cpu();
+      }
+
+      if (thread_mlfqs && (ticks % TIMER_FREQ == 0)) // Update load_avg and the running and ready threads every 'second' (100 ticks)
+      { 
+          calc_load_avg(); //load_avg 계산
+          recent_cpu_update(); //recent_cpu 업데이트
+      }
+
+      if (thread_mlfqs && (ticks % 4 == 0)) // Update the current thread's priority every 4 ticks
+      { 
+          MLFQS_priority_update(); 
+      }
+
+      /* Expire kernel timers, including those of sleeping threads. */
+      timerq_run (ticks);
+    }
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
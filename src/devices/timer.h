@@ -2,11 +2,18 @@
 #define DEVICES_TIMER_H
 
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* If false (default), the timer interrupts TIMER_FREQ times per
+   second at all times.
+   If true, the periodic tick is stopped while the CPU is idle.
+   Controlled by kernel command-line option "-tickless". */
+extern bool timer_tickless;
+
 void timer_init (void);
 void timer_calibrate (void);
 
@@ -24,6 +31,12 @@ void timer_mdelay (int64_t milliseconds);
 void timer_udelay (int64_t microseconds);
 void timer_ndelay (int64_t nanoseconds);
 
+uint64_t timer_cycles_to_ns (uint64_t cycles);
+
 void timer_print_stats (void);
 
+/* Dynamic tick mode. */
+void timer_idle_enter (void);
+void timer_idle_exit (void);
+
 #endif /* devices/timer.h */
@@ -0,0 +1,247 @@
+#include "devices/timerq.h"
+#include <debug.h>
+#include "threads/interrupt.h"
+
+/* Hierarchical timer wheel.
+
+   The wheel has WHEEL_LEVELS levels of WHEEL_SLOTS slots each.
+   Level 0 has one slot per tick and holds the events expiring
+   within the next WHEEL_SLOTS ticks.  Each slot of level N + 1
+   covers a whole turn of level N and holds events expiring
+   further in the future.  Whenever level N wraps around, the
+   next slot of level N + 1 is "cascaded": its events are
+   re-inserted, which moves each of them to a lower level.
+
+   An event is placed in exactly one slot, so arming and
+   cancelling it are plain list operations.  Events too far in the
+   future for the top level are parked in its farthest slot and
+   re-inserted from there, possibly more than once. */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 4
+
+/* Largest expiry distance that fits in the wheel. */
+#define WHEEL_MAX_DELTA (((int64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
+static struct list wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+
+/* Next tick to be processed by timerq_run().  Every tick before
+   this one has already been processed. */
+static int64_t wheel_clock;
+
+static void enqueue (struct timer_event *);
+static int cascade (int level, int slot);
+static int slot_index (int64_t tick, int level);
+
+/* Initializes the timer wheel. */
+void
+timerq_init (void) 
+{
+  int level, slot;
+
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    for (slot = 0; slot < WHEEL_SLOTS; slot++)
+      list_init (&wheel[level][slot]);
+  wheel_clock = 0;
+}
+
+/* Initializes timer event E to call FUNC with AUX when it
+   expires.  E is initially not armed. */
+void
+timer_event_init (struct timer_event *e, timer_event_func *func, void *aux) 
+{
+  ASSERT (e != NULL);
+  ASSERT (func != NULL);
+
+  e->func = func;
+  e->aux = aux;
+  e->expires = 0;
+  e->pending = false;
+}
+
+/* Arms E to expire at timer tick EXPIRES.  If E is already
+   pending, it is moved to the new expiry time.  An expiry time
+   that has already passed makes E expire on the next tick. */
+void
+timer_event_arm (struct timer_event *e, int64_t expires) 
+{
+  enum intr_level old_level;
+
+  ASSERT (e != NULL);
+
+  old_level = intr_disable ();
+  if (e->pending)
+    list_remove (&e->elem);
+  e->expires = expires;
+  e->pending = true;
+  enqueue (e);
+  intr_set_level (old_level);
+}
+
+/* Disarms E.  Returns true if E was pending, false if it had
+   already expired or was never armed. */
+bool
+timer_event_cancel (struct timer_event *e) 
+{
+  enum intr_level old_level;
+  bool was_pending;
+
+  ASSERT (e != NULL);
+
+  old_level = intr_disable ();
+  was_pending = e->pending;
+  if (was_pending)
+    {
+      list_remove (&e->elem);
+      e->pending = false;
+    }
+  intr_set_level (old_level);
+
+  return was_pending;
+}
+
+/* Returns true if E is armed and has not yet expired. */
+bool
+timer_event_pending (const struct timer_event *e) 
+{
+  return e->pending;
+}
+
+/* Processes every tick up to and including NOW, calling the
+   function of each event that expires.  Called by the timer
+   interrupt handler. */
+void
+timerq_run (int64_t now) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while (wheel_clock <= now)
+    {
+      struct list expired;
+      int slot = slot_index (wheel_clock, 0);
+      int level;
+
+      /* Cascade higher levels whenever the level below them
+         wraps around. */
+      for (level = 1; level < WHEEL_LEVELS && slot == 0; level++)
+        slot = cascade (level, slot_index (wheel_clock, level));
+
+      /* Detach the slot before running callbacks, so that
+         events re-armed by their callbacks are not run again
+         on this tick. */
+      list_init (&expired);
+      slot = slot_index (wheel_clock, 0);
+      while (!list_empty (&wheel[0][slot]))
+        list_push_back (&expired, list_pop_front (&wheel[0][slot]));
+
+      wheel_clock++;
+
+      while (!list_empty (&expired))
+        {
+          struct timer_event *e = list_entry (list_pop_front (&expired),
+                                              struct timer_event, elem);
+          e->pending = false;
+          e->func (e->aux);
+        }
+    }
+}
+
+/* Returns the earliest tick at which a pending event may expire,
+   or INT64_MAX if no event is pending.  The result is exact for
+   events due within the next WHEEL_SLOTS ticks and a lower bound
+   on the true expiry time otherwise.  Interrupts must be off. */
+int64_t
+timerq_next_expiry (void) 
+{
+  int64_t next = INT64_MAX;
+  int level, i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  /* Level 0 slots map one-to-one to upcoming ticks. */
+  for (i = 0; i < WHEEL_SLOTS; i++)
+    if (!list_empty (&wheel[0][slot_index (wheel_clock + i, 0)]))
+      return wheel_clock + i;
+
+  /* In higher levels, the first non-empty slot after the current
+     one holds the earliest events of that level. */
+  for (level = 1; level < WHEEL_LEVELS; level++)
+    {
+      int cur = slot_index (wheel_clock, level);
+
+      for (i = 1; i <= WHEEL_SLOTS; i++)
+        {
+          struct list *slot = &wheel[level][(cur + i) & WHEEL_MASK];
+          struct list_elem *elem;
+
+          if (list_empty (slot))
+            continue;
+          for (elem = list_begin (slot); elem != list_end (slot);
+               elem = list_next (elem))
+            {
+              struct timer_event *e = list_entry (elem, struct timer_event,
+                                                  elem);
+              if (e->expires < next)
+                next = e->expires;
+            }
+          break;
+        }
+    }
+
+  return next;
+}
+
+/* Puts pending event E into the wheel slot for its expiry
+   time. */
+static void
+enqueue (struct timer_event *e) 
+{
+  int64_t expires = e->expires;
+  int64_t delta = expires - wheel_clock;
+  int level;
+
+  if (delta < 0)
+    {
+      /* Already due: run on the next tick processed. */
+      expires = wheel_clock;
+      delta = 0;
+    }
+  else if (delta > WHEEL_MAX_DELTA)
+    {
+      /* Too far away: park it as far out as possible. */
+      expires = wheel_clock + WHEEL_MAX_DELTA;
+      delta = WHEEL_MAX_DELTA;
+    }
+
+  for (level = 0; level < WHEEL_LEVELS - 1; level++)
+    if (delta < (int64_t) 1 << (WHEEL_BITS * (level + 1)))
+      break;
+
+  list_push_back (&wheel[level][slot_index (expires, level)], &e->elem);
+}
+
+/* Re-inserts every event in SLOT of LEVEL, which moves them to
+   lower levels.  Returns SLOT, so that the caller can tell
+   whether LEVEL itself wrapped around. */
+static int
+cascade (int level, int slot) 
+{
+  struct list events;
+
+  list_init (&events);
+  while (!list_empty (&wheel[level][slot]))
+    list_push_back (&events, list_pop_front (&wheel[level][slot]));
+
+  while (!list_empty (&events))
+    enqueue (list_entry (list_pop_front (&events), struct timer_event, elem));
+
+  return slot;
+}
+
+/* Returns the slot of LEVEL that covers TICK. */
+static int
+slot_index (int64_t tick, int level) 
+{
+  return (tick >> (WHEEL_BITS * level)) & WHEEL_MASK;
+}
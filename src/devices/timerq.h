@@ -0,0 +1,45 @@
+#ifndef DEVICES_TIMERQ_H
+#define DEVICES_TIMERQ_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Kernel timers.
+
+   A timer event calls a function once the timer tick count
+   reaches the event's expiry time.  Pending events are kept in a
+   hierarchical timer wheel, so arming and cancelling an event
+   take constant time no matter how many events are pending, and
+   the per-tick cost depends only on the events that actually
+   expire.
+
+   Callbacks run in the timer interrupt handler, with interrupts
+   off, so they must not sleep.  A callback may re-arm its own
+   event, or arm and cancel any other event.  All other timer
+   event functions may be called from kernel threads or from
+   interrupt handlers. */
+
+/* Called when a timer event expires, with the event's AUX. */
+typedef void timer_event_func (void *aux);
+
+/* A timer event. */
+struct timer_event
+  {
+    struct list_elem elem;      /* Element in a timer wheel slot. */
+    int64_t expires;            /* Tick at which to call FUNC. */
+    timer_event_func *func;     /* Function to call. */
+    void *aux;                  /* Auxiliary data for FUNC. */
+    bool pending;               /* Armed and not yet expired? */
+  };
+
+void timerq_init (void);
+void timerq_run (int64_t now);
+int64_t timerq_next_expiry (void);
+
+void timer_event_init (struct timer_event *, timer_event_func *, void *aux);
+void timer_event_arm (struct timer_event *, int64_t expires);
+bool timer_event_cancel (struct timer_event *);
+bool timer_event_pending (const struct timer_event *);
+
+#endif /* devices/timerq.h */
@@ -6,6 +6,8 @@
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
+#include "threads/slab.h"
+#include "threads/synch.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -36,6 +38,7 @@ struct inode
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+    struct rwlock rwlock;               /* Orders reads against writes. */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -57,11 +60,15 @@ byte_to_sector (const struct inode *inode, off_t pos)
    returns the same `struct inode'. */
 static struct list open_inodes;
 
+/* Cache of struct inode. */
+static struct kmem_cache *inode_cache;
+
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
   list_init (&open_inodes);
+  inode_cache = kmem_cache_create ("inode", sizeof (struct inode), NULL);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -127,7 +134,7 @@ inode_open (block_sector_t sector)
     }
 
   /* Allocate memory. */
-  inode = malloc (sizeof *inode);
+  inode = kmem_cache_alloc (inode_cache);
   if (inode == NULL)
     return NULL;
 
@@ -137,6 +144,7 @@ inode_open (block_sector_t sector)
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
+  rwlock_init (&inode->rwlock);
   block_read (fs_device, inode->sector, &inode->data);
   return inode;
 }
@@ -181,7 +189,7 @@ inode_close (struct inode *inode)
                             bytes_to_sectors (inode->data.length)); 
         }
 
-      free (inode); 
+      kmem_cache_free (inode_cache, inode);
     }
 }
 
@@ -343,3 +351,33 @@ inode_length (const struct inode *inode)
 {
   return inode->data.length;
 }
+
+/* Acquires INODE's data for reading.  Any number of readers may
+   hold an inode at once, but not together with a writer. */
+void
+inode_read_lock (struct inode *inode) 
+{
+  rwlock_acquire_read (&inode->rwlock);
+}
+
+/* Releases INODE's data after inode_read_lock(). */
+void
+inode_read_unlock (struct inode *inode) 
+{
+  rwlock_release_read (&inode->rwlock);
+}
+
+/* Acquires INODE's data for writing, excluding every other
+   reader and writer of the same inode. */
+void
+inode_write_lock (struct inode *inode) 
+{
+  rwlock_acquire_write (&inode->rwlock);
+}
+
+/* Releases INODE's data after inode_write_lock(). */
+void
+inode_write_unlock (struct inode *inode) 
+{
+  rwlock_release_write (&inode->rwlock);
+}
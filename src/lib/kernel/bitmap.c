@@ -60,6 +60,37 @@ byte_cnt (size_t bit_cnt)
   return sizeof (elem_type) * elem_cnt (bit_cnt);
 }
 
+/* Returns an elem_type with the CNT bits starting at bit OFS
+   turned on.  OFS + CNT must not exceed ELEM_BITS. */
+static inline elem_type
+range_mask (size_t ofs, size_t cnt) 
+{
+  ASSERT (cnt > 0 && ofs + cnt <= ELEM_BITS);
+  return ((elem_type) -1 >> (ELEM_BITS - cnt)) << ofs;
+}
+
+/* Returns the index of the lowest bit set in W, which must be
+   nonzero.  This is a single BSF instruction. */
+static inline size_t
+first_set (elem_type w) 
+{
+  ASSERT (w != 0);
+  return __builtin_ctzl (w);
+}
+
+/* Returns the number of bits set in W, which is 32 bits wide,
+   as the inline assembly in this file also assumes.  The kernel
+   is not linked with libgcc, so __builtin_popcountl() is not
+   available. */
+static inline size_t
+count_set (elem_type w) 
+{
+  w = w - ((w >> 1) & 0x55555555);
+  w = (w & 0x33333333) + ((w >> 2) & 0x33333333);
+  w = (w + (w >> 4)) & 0x0f0f0f0f;
+  return (w * 0x01010101) >> 24;
+}
+
 /* Returns a bit mask in which the bits actually used in the last
    element of B's bits are set to 1 and the rest are set to 0. */
 static inline elem_type
@@ -213,18 +244,36 @@ bitmap_set_all (struct bitmap *b, bool value)
   bitmap_set_multiple (b, 0, bitmap_size (b), value);
 }
 
+/* The functions below work on a whole element at a time.  A
+   range of bits covers a partial element at either end, if it
+   does not start or end on an element boundary, and whole
+   elements in between. */
+
 /* Sets the CNT bits starting at START in B to VALUE. */
 void
 bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
-  size_t i;
-  
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    bitmap_set (b, start + i, value);
+  while (cnt > 0)
+    {
+      size_t ofs = start % ELEM_BITS;
+      size_t n = ELEM_BITS - ofs < cnt ? ELEM_BITS - ofs : cnt;
+      elem_type *e = &b->bits[elem_idx (start)];
+      elem_type mask = range_mask (ofs, n);
+
+      /* As in bitmap_mark() and bitmap_reset(), each element is
+         updated atomically. */
+      if (value)
+        asm ("orl %1, %0" : "=m" (*e) : "r" (mask) : "cc");
+      else
+        asm ("andl %1, %0" : "=m" (*e) : "r" (~mask) : "cc");
+
+      start += n;
+      cnt -= n;
+    }
 }
 
 /* Returns the number of bits in B between START and START + CNT,
@@ -232,16 +281,25 @@ bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value)
 size_t
 bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
-  size_t i, value_cnt;
+  size_t value_cnt;
 
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
   value_cnt = 0;
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test (b, start + i) == value)
-      value_cnt++;
+  while (cnt > 0)
+    {
+      size_t ofs = start % ELEM_BITS;
+      size_t n = ELEM_BITS - ofs < cnt ? ELEM_BITS - ofs : cnt;
+      size_t ones = count_set (b->bits[elem_idx (start)]
+                                & range_mask (ofs, n));
+
+      value_cnt += value ? ones : n - ones;
+
+      start += n;
+      cnt -= n;
+    }
   return value_cnt;
 }
 
@@ -250,15 +308,23 @@ bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
 bool
 bitmap_contains (const struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
-  size_t i;
-  
+  elem_type flip = value ? 0 : (elem_type) -1;
+
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test (b, start + i) == value)
-      return true;
+  while (cnt > 0)
+    {
+      size_t ofs = start % ELEM_BITS;
+      size_t n = ELEM_BITS - ofs < cnt ? ELEM_BITS - ofs : cnt;
+
+      if ((b->bits[elem_idx (start)] ^ flip) & range_mask (ofs, n))
+        return true;
+
+      start += n;
+      cnt -= n;
+    }
   return false;
 }
 
@@ -288,6 +354,33 @@ bitmap_all (const struct bitmap *b, size_t start, size_t cnt)
 
 /* Finding set or unset bits. */
 
+/* Returns the index of the first bit in B at or after START that
+   is set to VALUE, or B's size if there is none.  Elements with
+   no such bit are skipped whole. */
+static size_t
+find_next (const struct bitmap *b, size_t start, bool value) 
+{
+  elem_type flip = value ? 0 : (elem_type) -1;
+  size_t idx, last_idx;
+  elem_type w;
+
+  if (start >= b->bit_cnt)
+    return b->bit_cnt;
+
+  idx = elem_idx (start);
+  last_idx = elem_cnt (b->bit_cnt) - 1;
+  w = (b->bits[idx] ^ flip) & ((elem_type) -1 << (start % ELEM_BITS));
+  while (w == 0)
+    {
+      if (idx == last_idx)
+        return b->bit_cnt;
+      w = b->bits[++idx] ^ flip;
+    }
+
+  start = idx * ELEM_BITS + first_set (w);
+  return start < b->bit_cnt ? start : b->bit_cnt;
+}
+
 /* Finds and returns the starting index of the first group of CNT
    consecutive bits in B at or after START that are all set to
    VALUE.
@@ -301,10 +394,25 @@ bitmap_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
   if (cnt <= b->bit_cnt) 
     {
       size_t last = b->bit_cnt - cnt;
-      size_t i;
-      for (i = start; i <= last; i++)
-        if (!bitmap_contains (b, i, cnt, !value))
-          return i; 
+      size_t i = start;
+
+      if (cnt == 0)
+        return i <= last ? i : BITMAP_ERROR;
+
+      /* Jump from the start of each run of VALUE bits to its end,
+         until a run is long enough.  Runs may span elements. */
+      while (i <= last)
+        {
+          size_t end;
+
+          i = find_next (b, i, value);
+          if (i > last)
+            break;
+          end = find_next (b, i + 1, !value);
+          if (end - i >= cnt)
+            return i;
+          i = end;
+        }
     }
   return BITMAP_ERROR;
 }
@@ -0,0 +1,202 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* A pairing heap is a tree in which every node is greater than
+   or equal to its children.  The children of a node form a
+   doubly linked list starting at the node's `child' member; the
+   first child's `prev' points back to the parent.
+
+   Pushing melds the new element with the root.  Popping the root
+   melds its children in pairs, left to right, and then melds the
+   pairs right to left. */
+
+static struct heap_elem *meld (struct heap *,
+                               struct heap_elem *, struct heap_elem *);
+static struct heap_elem *merge_pairs (struct heap *, struct heap_elem *);
+static void detach (struct heap_elem *);
+
+/* Initializes HEAP as an empty heap ordered by LESS given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *heap, heap_less_func *less, void *aux) 
+{
+  ASSERT (heap != NULL);
+  ASSERT (less != NULL);
+
+  heap->root = NULL;
+  heap->size = 0;
+  heap->less = less;
+  heap->aux = aux;
+}
+
+/* Inserts ELEM into HEAP. */
+void
+heap_push (struct heap *heap, struct heap_elem *elem) 
+{
+  ASSERT (heap != NULL);
+  ASSERT (elem != NULL);
+
+  elem->child = elem->next = elem->prev = NULL;
+  heap->root = heap->root != NULL ? meld (heap, heap->root, elem) : elem;
+  heap->size++;
+}
+
+/* Returns the greatest element in HEAP, or a null pointer if
+   HEAP is empty. */
+struct heap_elem *
+heap_top (const struct heap *heap) 
+{
+  ASSERT (heap != NULL);
+
+  return heap->root;
+}
+
+/* Removes and returns the greatest element in HEAP, which must
+   not be empty. */
+struct heap_elem *
+heap_pop (struct heap *heap) 
+{
+  struct heap_elem *top;
+
+  ASSERT (heap != NULL);
+  ASSERT (!heap_empty (heap));
+
+  top = heap->root;
+  heap->root = merge_pairs (heap, top->child);
+  heap->size--;
+  top->child = NULL;
+  return top;
+}
+
+/* Removes ELEM, which must be in HEAP, from HEAP. */
+void
+heap_remove (struct heap *heap, struct heap_elem *elem) 
+{
+  struct heap_elem *sub;
+
+  ASSERT (heap != NULL);
+  ASSERT (elem != NULL);
+
+  if (elem == heap->root)
+    {
+      heap_pop (heap);
+      return;
+    }
+
+  detach (elem);
+  sub = merge_pairs (heap, elem->child);
+  if (sub != NULL)
+    heap->root = meld (heap, heap->root, sub);
+  heap->size--;
+  elem->child = elem->next = elem->prev = NULL;
+}
+
+/* Restores HEAP's ordering after the key of ELEM, which must be
+   in HEAP, has changed. */
+void
+heap_update (struct heap *heap, struct heap_elem *elem) 
+{
+  heap_remove (heap, elem);
+  heap_push (heap, elem);
+}
+
+/* Returns the number of elements in HEAP. */
+size_t
+heap_size (const struct heap *heap) 
+{
+  ASSERT (heap != NULL);
+
+  return heap->size;
+}
+
+/* Returns true if HEAP is empty, false otherwise. */
+bool
+heap_empty (const struct heap *heap) 
+{
+  ASSERT (heap != NULL);
+
+  return heap->root == NULL;
+}
+
+/* Melds the trees rooted at A and B, neither of which may have
+   siblings, and returns the root of the result. */
+static struct heap_elem *
+meld (struct heap *heap, struct heap_elem *a, struct heap_elem *b) 
+{
+  if (heap->less (a, b, heap->aux))
+    {
+      struct heap_elem *t = a;
+      a = b;
+      b = t;
+    }
+
+  /* Make B the first child of A. */
+  b->prev = a;
+  b->next = a->child;
+  if (a->child != NULL)
+    a->child->prev = b;
+  a->child = b;
+  return a;
+}
+
+/* Melds the sibling list starting at FIRST into one tree and
+   returns its root, or a null pointer if FIRST is null. */
+static struct heap_elem *
+merge_pairs (struct heap *heap, struct heap_elem *first) 
+{
+  struct heap_elem *pairs = NULL;
+  struct heap_elem *result;
+
+  /* Left to right, meld siblings in pairs.  The melded pairs are
+     chained through `next' in reverse order. */
+  while (first != NULL)
+    {
+      struct heap_elem *a = first;
+      struct heap_elem *b = a->next;
+      struct heap_elem *m;
+
+      a->prev = a->next = NULL;
+      if (b != NULL)
+        {
+          first = b->next;
+          b->prev = b->next = NULL;
+          m = meld (heap, a, b);
+        }
+      else
+        {
+          first = NULL;
+          m = a;
+        }
+      m->next = pairs;
+      pairs = m;
+    }
+
+  /* Right to left, meld the pairs together. */
+  if (pairs == NULL)
+    return NULL;
+  result = pairs;
+  pairs = pairs->next;
+  result->next = NULL;
+  while (pairs != NULL)
+    {
+      struct heap_elem *p = pairs;
+      pairs = p->next;
+      p->next = NULL;
+      result = meld (heap, result, p);
+    }
+  return result;
+}
+
+/* Unlinks non-root ELEM, along with its subtree, from its parent
+   and siblings. */
+static void
+detach (struct heap_elem *elem) 
+{
+  if (elem->prev->child == elem)
+    elem->prev->child = elem->next;
+  else
+    elem->prev->next = elem->next;
+  if (elem->next != NULL)
+    elem->next->prev = elem->prev;
+  elem->prev = elem->next = NULL;
+}
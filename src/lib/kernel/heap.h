@@ -0,0 +1,73 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue (pairing heap).
+
+   Like the doubly linked list in list.h, this heap does not
+   require dynamically allocated memory.  Each structure that can
+   be in a heap embeds a struct heap_elem member, and heap_entry()
+   converts a struct heap_elem back to the structure that contains
+   it.
+
+   The heap is ordered by a heap_less_func supplied at
+   initialization.  heap_top() and heap_pop() return the
+   *greatest* element, the one that is not less than any other,
+   so that a heap of threads compared by priority yields the
+   highest-priority thread first.  Elements that compare equal
+   come out in no particular order.
+
+   heap_push() and heap_top() take constant time.  heap_pop(),
+   heap_remove() and heap_update() take O(log n) amortized time.
+
+   If an element's key changes while it is in a heap, the heap
+   must be told with heap_update() before it is used again. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem 
+  {
+    struct heap_elem *child;    /* First child. */
+    struct heap_elem *next;     /* Next sibling. */
+    struct heap_elem *prev;     /* Previous sibling, or parent of a
+                                   first child, or null for root. */
+  };
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap 
+  {
+    struct heap_elem *root;     /* Greatest element, or null. */
+    size_t size;                /* Number of elements. */
+    heap_less_func *less;       /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+        ((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->child    \
+                     - offsetof (STRUCT, MEMBER.child)))
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+void heap_push (struct heap *, struct heap_elem *);
+struct heap_elem *heap_top (const struct heap *);
+struct heap_elem *heap_pop (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+void heap_update (struct heap *, struct heap_elem *);
+
+size_t heap_size (const struct heap *);
+bool heap_empty (const struct heap *);
+
+#endif /* lib/kernel/heap.h */
@@ -0,0 +1,393 @@
+#include "rbtree.h"
+#include "../debug.h"
+
+/* A red-black tree is a binary search tree in which every node
+   is either red or black, the root is black, a red node has no
+   red child, and every path from a node down to a null leaf
+   passes through the same number of black nodes.  Together these
+   keep the height of a tree of n nodes under 2 log2 (n + 1).
+
+   Insertion and removal follow Cormen et al., "Introduction to
+   Algorithms", chapter 13, with null pointers in place of the
+   sentinel leaf.  Because a null leaf has no parent pointer,
+   removal's fix-up is passed the parent of the node it starts
+   from explicitly. */
+
+static bool is_red (const struct rb_elem *);
+static void rotate_left (struct rbtree *, struct rb_elem *);
+static void rotate_right (struct rbtree *, struct rb_elem *);
+static void replace_child (struct rbtree *, struct rb_elem *parent,
+                           struct rb_elem *old, struct rb_elem *new);
+static void insert_fixup (struct rbtree *, struct rb_elem *);
+static void remove_fixup (struct rbtree *, struct rb_elem *,
+                          struct rb_elem *parent);
+static struct rb_elem *subtree_min (struct rb_elem *);
+static struct rb_elem *subtree_max (struct rb_elem *);
+
+/* Initializes TREE as an empty tree ordered by LESS given
+   auxiliary data AUX. */
+void
+rbtree_init (struct rbtree *tree, rb_less_func *less, void *aux)
+{
+  ASSERT (tree != NULL);
+  ASSERT (less != NULL);
+
+  tree->root = tree->min = NULL;
+  tree->size = 0;
+  tree->less = less;
+  tree->aux = aux;
+}
+
+/* Inserts ELEM into TREE, after any elements equal to it. */
+void
+rbtree_insert (struct rbtree *tree, struct rb_elem *elem)
+{
+  struct rb_elem *parent = NULL;
+  struct rb_elem **link = &tree->root;
+  bool leftmost = true;
+
+  ASSERT (tree != NULL);
+  ASSERT (elem != NULL);
+
+  while (*link != NULL)
+    {
+      parent = *link;
+      if (tree->less (elem, parent, tree->aux))
+        link = &parent->left;
+      else
+        {
+          link = &parent->right;
+          leftmost = false;
+        }
+    }
+
+  elem->parent = parent;
+  elem->left = elem->right = NULL;
+  elem->red = true;
+  *link = elem;
+  if (leftmost)
+    tree->min = elem;
+  tree->size++;
+
+  insert_fixup (tree, elem);
+}
+
+/* Removes ELEM, which must be in TREE, from TREE. */
+void
+rbtree_remove (struct rbtree *tree, struct rb_elem *elem)
+{
+  struct rb_elem *child, *parent;
+  bool removed_red;
+
+  ASSERT (tree != NULL);
+  ASSERT (elem != NULL);
+  ASSERT (tree->size > 0);
+
+  if (tree->min == elem)
+    tree->min = rbtree_next (elem);
+
+  if (elem->left == NULL || elem->right == NULL)
+    {
+      /* At most one child: splice ELEM out. */
+      child = elem->left != NULL ? elem->left : elem->right;
+      parent = elem->parent;
+      removed_red = elem->red;
+      if (child != NULL)
+        child->parent = parent;
+      replace_child (tree, parent, elem, child);
+    }
+  else
+    {
+      /* Two children: move ELEM's successor, which has no left
+         child, into ELEM's place. */
+      struct rb_elem *succ = subtree_min (elem->right);
+
+      child = succ->right;
+      removed_red = succ->red;
+      if (succ->parent == elem)
+        parent = succ;
+      else
+        {
+          parent = succ->parent;
+          parent->left = child;
+          if (child != NULL)
+            child->parent = parent;
+          succ->right = elem->right;
+          succ->right->parent = succ;
+        }
+      succ->left = elem->left;
+      succ->left->parent = succ;
+      succ->parent = elem->parent;
+      succ->red = elem->red;
+      replace_child (tree, elem->parent, elem, succ);
+    }
+  tree->size--;
+
+  if (!removed_red)
+    remove_fixup (tree, child, parent);
+}
+
+/* Returns the least element in TREE, or a null pointer if TREE
+   is empty.  Of several equal least elements, returns the one
+   inserted first. */
+struct rb_elem *
+rbtree_min (const struct rbtree *tree)
+{
+  ASSERT (tree != NULL);
+
+  return tree->min;
+}
+
+/* Returns the greatest element in TREE, or a null pointer if
+   TREE is empty. */
+struct rb_elem *
+rbtree_max (const struct rbtree *tree)
+{
+  ASSERT (tree != NULL);
+
+  return tree->root != NULL ? subtree_max (tree->root) : NULL;
+}
+
+/* Returns the element that follows ELEM in its tree, or a null
+   pointer if ELEM is the last element. */
+struct rb_elem *
+rbtree_next (struct rb_elem *elem)
+{
+  ASSERT (elem != NULL);
+
+  if (elem->right != NULL)
+    return subtree_min (elem->right);
+  while (elem->parent != NULL && elem == elem->parent->right)
+    elem = elem->parent;
+  return elem->parent;
+}
+
+/* Returns the element that precedes ELEM in its tree, or a null
+   pointer if ELEM is the first element. */
+struct rb_elem *
+rbtree_prev (struct rb_elem *elem)
+{
+  ASSERT (elem != NULL);
+
+  if (elem->left != NULL)
+    return subtree_max (elem->left);
+  while (elem->parent != NULL && elem == elem->parent->left)
+    elem = elem->parent;
+  return elem->parent;
+}
+
+/* Returns the number of elements in TREE. */
+size_t
+rbtree_size (const struct rbtree *tree)
+{
+  ASSERT (tree != NULL);
+
+  return tree->size;
+}
+
+/* Returns true if TREE is empty, false otherwise. */
+bool
+rbtree_empty (const struct rbtree *tree)
+{
+  ASSERT (tree != NULL);
+
+  return tree->root == NULL;
+}
+
+/* Returns true if E is a red node.  Null leaves are black. */
+static bool
+is_red (const struct rb_elem *e)
+{
+  return e != NULL && e->red;
+}
+
+/* Makes NEW take the place of OLD as a child of PARENT, or as
+   the root of TREE if PARENT is null.  NEW's own parent pointer
+   is left for the caller to set. */
+static void
+replace_child (struct rbtree *tree, struct rb_elem *parent,
+               struct rb_elem *old, struct rb_elem *new)
+{
+  if (parent == NULL)
+    tree->root = new;
+  else if (parent->left == old)
+    parent->left = new;
+  else
+    parent->right = new;
+}
+
+/* Rotates the subtree rooted at X to the left, so that X's right
+   child takes X's place and X becomes its left child. */
+static void
+rotate_left (struct rbtree *tree, struct rb_elem *x)
+{
+  struct rb_elem *y = x->right;
+
+  x->right = y->left;
+  if (y->left != NULL)
+    y->left->parent = x;
+  y->parent = x->parent;
+  replace_child (tree, x->parent, x, y);
+  y->left = x;
+  x->parent = y;
+}
+
+/* Rotates the subtree rooted at X to the right, so that X's left
+   child takes X's place and X becomes its right child. */
+static void
+rotate_right (struct rbtree *tree, struct rb_elem *x)
+{
+  struct rb_elem *y = x->left;
+
+  x->left = y->right;
+  if (y->right != NULL)
+    y->right->parent = x;
+  y->parent = x->parent;
+  replace_child (tree, x->parent, x, y);
+  y->right = x;
+  x->parent = y;
+}
+
+/* Restores the red-black properties after inserting red node E,
+   which may have a red parent. */
+static void
+insert_fixup (struct rbtree *tree, struct rb_elem *e)
+{
+  while (is_red (e->parent))
+    {
+      struct rb_elem *parent = e->parent;
+      struct rb_elem *grandparent = parent->parent;
+
+      if (parent == grandparent->left)
+        {
+          struct rb_elem *uncle = grandparent->right;
+          if (is_red (uncle))
+            {
+              parent->red = uncle->red = false;
+              grandparent->red = true;
+              e = grandparent;
+              continue;
+            }
+          if (e == parent->right)
+            {
+              rotate_left (tree, parent);
+              e = parent;
+              parent = e->parent;
+            }
+          parent->red = false;
+          grandparent->red = true;
+          rotate_right (tree, grandparent);
+        }
+      else
+        {
+          struct rb_elem *uncle = grandparent->left;
+          if (is_red (uncle))
+            {
+              parent->red = uncle->red = false;
+              grandparent->red = true;
+              e = grandparent;
+              continue;
+            }
+          if (e == parent->left)
+            {
+              rotate_right (tree, parent);
+              e = parent;
+              parent = e->parent;
+            }
+          parent->red = false;
+          grandparent->red = true;
+          rotate_left (tree, grandparent);
+        }
+    }
+  tree->root->red = false;
+}
+
+/* Restores the red-black properties after removing a black node
+   from the path through X, which may be null, and its parent
+   PARENT: X counts as carrying an extra black. */
+static void
+remove_fixup (struct rbtree *tree, struct rb_elem *x, struct rb_elem *parent)
+{
+  while (x != tree->root && !is_red (x))
+    {
+      if (x == parent->left)
+        {
+          struct rb_elem *sibling = parent->right;
+          if (is_red (sibling))
+            {
+              sibling->red = false;
+              parent->red = true;
+              rotate_left (tree, parent);
+              sibling = parent->right;
+            }
+          if (!is_red (sibling->left) && !is_red (sibling->right))
+            {
+              sibling->red = true;
+              x = parent;
+              parent = x->parent;
+              continue;
+            }
+          if (!is_red (sibling->right))
+            {
+              sibling->left->red = false;
+              sibling->red = true;
+              rotate_right (tree, sibling);
+              sibling = parent->right;
+            }
+          sibling->red = parent->red;
+          parent->red = false;
+          sibling->right->red = false;
+          rotate_left (tree, parent);
+        }
+      else
+        {
+          struct rb_elem *sibling = parent->left;
+          if (is_red (sibling))
+            {
+              sibling->red = false;
+              parent->red = true;
+              rotate_right (tree, parent);
+              sibling = parent->left;
+            }
+          if (!is_red (sibling->left) && !is_red (sibling->right))
+            {
+              sibling->red = true;
+              x = parent;
+              parent = x->parent;
+              continue;
+            }
+          if (!is_red (sibling->left))
+            {
+              sibling->right->red = false;
+              sibling->red = true;
+              rotate_left (tree, sibling);
+              sibling = parent->left;
+            }
+          sibling->red = parent->red;
+          parent->red = false;
+          sibling->left->red = false;
+          rotate_right (tree, parent);
+        }
+      x = tree->root;
+    }
+  if (x != NULL)
+    x->red = false;
+}
+
+/* Returns the least element in the subtree rooted at E. */
+static struct rb_elem *
+subtree_min (struct rb_elem *e)
+{
+  while (e->left != NULL)
+    e = e->left;
+  return e;
+}
+
+/* Returns the greatest element in the subtree rooted at E. */
+static struct rb_elem *
+subtree_max (struct rb_elem *e)
+{
+  while (e->right != NULL)
+    e = e->right;
+  return e;
+}
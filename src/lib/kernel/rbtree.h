@@ -0,0 +1,76 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Ordered set (red-black tree).
+
+   Like the doubly linked list in list.h, this tree does not
+   require dynamically allocated memory.  Each structure that can
+   be in a tree embeds a struct rb_elem member, and rbtree_entry()
+   converts a struct rb_elem back to the structure that contains
+   it.
+
+   The tree is ordered by an rb_less_func supplied at
+   initialization.  It may hold several elements that compare
+   equal; a newly inserted element goes after those already in
+   the tree, so that equal elements come out first-in, first-out.
+
+   rbtree_insert() and rbtree_remove() take O(log n) time.
+   rbtree_min() takes constant time, because the tree keeps track
+   of its least element, and rbtree_next() and rbtree_prev() take
+   O(log n) time (constant time amortized over a full walk).
+
+   An element's key must not change while it is in a tree.
+   Remove the element, change the key, and insert it again. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Tree element. */
+struct rb_elem
+  {
+    struct rb_elem *parent;     /* Parent, or null for the root. */
+    struct rb_elem *left;       /* Lesser subtree. */
+    struct rb_elem *right;      /* Greater or equal subtree. */
+    bool red;                   /* Red or black node? */
+  };
+
+/* Compares the value of two tree elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool rb_less_func (const struct rb_elem *a,
+                           const struct rb_elem *b,
+                           void *aux);
+
+/* Red-black tree. */
+struct rbtree
+  {
+    struct rb_elem *root;       /* Root, or null if empty. */
+    struct rb_elem *min;        /* Least element, or null if empty. */
+    size_t size;                /* Number of elements. */
+    rb_less_func *less;         /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+/* Converts pointer to tree element RB_ELEM into a pointer to
+   the structure that RB_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the tree element. */
+#define rbtree_entry(RB_ELEM, STRUCT, MEMBER)           \
+        ((STRUCT *) ((uint8_t *) &(RB_ELEM)->parent     \
+                     - offsetof (STRUCT, MEMBER.parent)))
+
+void rbtree_init (struct rbtree *, rb_less_func *, void *aux);
+
+void rbtree_insert (struct rbtree *, struct rb_elem *);
+void rbtree_remove (struct rbtree *, struct rb_elem *);
+
+struct rb_elem *rbtree_min (const struct rbtree *);
+struct rb_elem *rbtree_max (const struct rbtree *);
+struct rb_elem *rbtree_next (struct rb_elem *);
+struct rb_elem *rbtree_prev (struct rb_elem *);
+
+size_t rbtree_size (const struct rbtree *);
+bool rbtree_empty (const struct rbtree *);
+
+#endif /* lib/kernel/rbtree.h */
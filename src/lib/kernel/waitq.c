@@ -0,0 +1,124 @@
+#include "waitq.h"
+#include "../debug.h"
+
+static heap_less_func waitq_less;
+
+/* Initializes Q as an empty wait queue. */
+void
+waitq_init (struct waitq *q) 
+{
+  ASSERT (q != NULL);
+
+  heap_init (&q->heap, waitq_less, NULL);
+  q->seq = 0;
+}
+
+/* Adds ELEM, which must not already be in a wait queue, to Q
+   with the given KEY.  ELEM goes behind any waiters already in Q
+   with the same key. */
+void
+waitq_push (struct waitq *q, struct waitq_elem *elem, int key) 
+{
+  ASSERT (q != NULL);
+  ASSERT (elem != NULL);
+
+  elem->queue = q;
+  elem->key = key;
+  elem->seq = q->seq++;
+  heap_push (&q->heap, &elem->elem);
+}
+
+/* Returns the waiter in Q that would be popped next, or a null
+   pointer if Q is empty. */
+struct waitq_elem *
+waitq_top (const struct waitq *q) 
+{
+  struct heap_elem *top;
+
+  ASSERT (q != NULL);
+
+  top = heap_top (&q->heap);
+  return top != NULL ? heap_entry (top, struct waitq_elem, elem) : NULL;
+}
+
+/* Removes and returns the waiter in Q with the greatest key that
+   has waited longest.  Q must not be empty. */
+struct waitq_elem *
+waitq_pop (struct waitq *q) 
+{
+  struct waitq_elem *elem;
+
+  ASSERT (q != NULL);
+  ASSERT (!waitq_empty (q));
+
+  elem = heap_entry (heap_pop (&q->heap), struct waitq_elem, elem);
+  elem->queue = NULL;
+  return elem;
+}
+
+/* Removes ELEM from the wait queue that it is in. */
+void
+waitq_remove (struct waitq_elem *elem) 
+{
+  ASSERT (waitq_queued (elem));
+
+  heap_remove (&elem->queue->heap, &elem->elem);
+  elem->queue = NULL;
+}
+
+/* Changes ELEM's key to KEY.  If ELEM is in a wait queue, it
+   keeps its place among waiters with the same key.  Otherwise
+   the new key is simply recorded. */
+void
+waitq_rekey (struct waitq_elem *elem, int key) 
+{
+  ASSERT (elem != NULL);
+
+  if (elem->key == key)
+    return;
+  elem->key = key;
+  if (elem->queue != NULL)
+    heap_update (&elem->queue->heap, &elem->elem);
+}
+
+/* Returns the number of waiters in Q. */
+size_t
+waitq_size (const struct waitq *q) 
+{
+  ASSERT (q != NULL);
+
+  return heap_size (&q->heap);
+}
+
+/* Returns true if Q has no waiters, false otherwise. */
+bool
+waitq_empty (const struct waitq *q) 
+{
+  ASSERT (q != NULL);
+
+  return heap_empty (&q->heap);
+}
+
+/* Returns true if ELEM is in a wait queue, false otherwise. */
+bool
+waitq_queued (const struct waitq_elem *elem) 
+{
+  ASSERT (elem != NULL);
+
+  return elem->queue != NULL;
+}
+
+/* Orders wait queue elements by key, and among equal keys puts
+   later arrivals below earlier ones.  Sequence numbers are
+   compared by their difference so that wraparound is harmless. */
+static bool
+waitq_less (const struct heap_elem *a_, const struct heap_elem *b_,
+            void *aux UNUSED) 
+{
+  const struct waitq_elem *a = heap_entry (a_, struct waitq_elem, elem);
+  const struct waitq_elem *b = heap_entry (b_, struct waitq_elem, elem);
+
+  if (a->key != b->key)
+    return a->key < b->key;
+  return (int) (a->seq - b->seq) > 0;
+}
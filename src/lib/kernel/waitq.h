@@ -0,0 +1,63 @@
+#ifndef __LIB_KERNEL_WAITQ_H
+#define __LIB_KERNEL_WAITQ_H
+
+/* Wait queue.
+
+   A wait queue is a heap of waiters, each with an integer key
+   such as a thread priority.  waitq_pop() returns the waiter
+   with the greatest key, and among waiters with equal keys the
+   one that has waited longest, so that waiters of the same
+   priority are served first-come, first-served.
+
+   Like struct heap_elem, struct waitq_elem is embedded in the
+   structure that waits, and waitq_entry() converts it back.
+   Each element remembers the queue it is in, so that a waiter
+   whose key changes while it waits (for example, because it
+   received a priority donation) can be re-keyed with
+   waitq_rekey() without knowing which queue that is.
+
+   waitq_push() takes constant time; waitq_pop(),
+   waitq_remove() and waitq_rekey() take O(log n) amortized
+   time. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "heap.h"
+
+/* Wait queue element. */
+struct waitq_elem 
+  {
+    struct heap_elem elem;      /* Heap element. */
+    struct waitq *queue;        /* Queue we are in, or null. */
+    int key;                    /* Greater keys are served first. */
+    unsigned seq;               /* Arrival order, for ties. */
+  };
+
+/* Wait queue. */
+struct waitq 
+  {
+    struct heap heap;           /* Waiters. */
+    unsigned seq;               /* Next arrival number. */
+  };
+
+/* Converts pointer to wait queue element WAITQ_ELEM into a
+   pointer to the structure that WAITQ_ELEM is embedded inside.
+   Supply the name of the outer structure STRUCT and the member
+   name MEMBER of the wait queue element. */
+#define waitq_entry(WAITQ_ELEM, STRUCT, MEMBER)         \
+        ((STRUCT *) ((uint8_t *) &(WAITQ_ELEM)->elem    \
+                     - offsetof (STRUCT, MEMBER.elem)))
+
+void waitq_init (struct waitq *);
+
+void waitq_push (struct waitq *, struct waitq_elem *, int key);
+struct waitq_elem *waitq_top (const struct waitq *);
+struct waitq_elem *waitq_pop (struct waitq *);
+void waitq_remove (struct waitq_elem *);
+void waitq_rekey (struct waitq_elem *, int key);
+
+size_t waitq_size (const struct waitq *);
+bool waitq_empty (const struct waitq *);
+bool waitq_queued (const struct waitq_elem *);
+
+#endif /* lib/kernel/waitq.h */
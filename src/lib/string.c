@@ -1,5 +1,22 @@
 #include <string.h>
 #include <debug.h>
+#include <stdint.h>
+
+/* memcpy(), memmove(), memset(), memcmp() and strlen() work a
+   32-bit word at a time.  Blocks of SMALL_SIZE bytes or more are
+   copied and filled with REP MOVSL and REP STOSL, after a
+   prologue that aligns the destination to a word boundary, and
+   an epilogue for the bytes left over.  Smaller blocks use plain
+   loops instead, because the string instructions take a few
+   dozen cycles to start up.  The small loops load and store
+   unaligned words, which x86 allows. */
+#define SMALL_SIZE 64
+
+/* An unaligned word that may alias any other type. */
+typedef uint32_t uword __attribute__ ((aligned (1), may_alias));
+
+static void copy_forward (unsigned char *dst, const unsigned char *src,
+                          size_t size);
 
 /* Copies SIZE bytes from SRC to DST, which must not overlap.
    Returns DST. */
@@ -12,9 +29,7 @@ memcpy (void *dst_, const void *src_, size_t size)
   ASSERT (dst != NULL || size == 0);
   ASSERT (src != NULL || size == 0);
 
-  while (size-- > 0)
-    *dst++ = *src++;
-
+  copy_forward (dst, src, size);
   return dst_;
 }
 
@@ -29,20 +44,25 @@ memmove (void *dst_, const void *src_, size_t size)
   ASSERT (dst != NULL || size == 0);
   ASSERT (src != NULL || size == 0);
 
-  if (dst < src) 
-    {
-      while (size-- > 0)
-        *dst++ = *src++;
-    }
+  if (dst <= src || dst >= src + size) 
+    copy_forward (dst, src, size);
   else 
     {
+      /* Copy backward.  Each word is loaded before it is stored,
+         so overlap by less than a word is fine too. */
       dst += size;
       src += size;
+      for (; size >= 4; size -= 4) 
+        {
+          dst -= 4;
+          src -= 4;
+          *(uword *) dst = *(const uword *) src;
+        }
       while (size-- > 0)
         *--dst = *--src;
     }
 
-  return dst;
+  return dst_;
 }
 
 /* Find the first differing byte in the two blocks of SIZE bytes
@@ -58,6 +78,10 @@ memcmp (const void *a_, const void *b_, size_t size)
   ASSERT (a != NULL || size == 0);
   ASSERT (b != NULL || size == 0);
 
+  /* Skip equal words, then find the differing byte. */
+  for (; size >= 4; size -= 4, a += 4, b += 4)
+    if (*(const uword *) a != *(const uword *) b)
+      break;
   for (; size-- > 0; a++, b++)
     if (*a != *b)
       return *a > *b ? +1 : -1;
@@ -279,11 +303,30 @@ void *
 memset (void *dst_, int value, size_t size) 
 {
   unsigned char *dst = dst_;
+  uint32_t word = (unsigned char) value * 0x01010101u;
 
   ASSERT (dst != NULL || size == 0);
   
-  while (size-- > 0)
-    *dst++ = value;
+  if (size < SMALL_SIZE) 
+    {
+      for (; size >= 4; size -= 4, dst += 4)
+        *(uword *) dst = word;
+      while (size-- > 0)
+        *dst++ = value;
+    }
+  else 
+    {
+      size_t head = -(uintptr_t) dst & 3;
+      size_t word_cnt = (size - head) / 4;
+      size_t tail = (size - head) % 4;
+
+      asm volatile ("rep stosb"
+                    : "+D" (dst), "+c" (head) : "a" (word) : "memory");
+      asm volatile ("rep stosl"
+                    : "+D" (dst), "+c" (word_cnt) : "a" (word) : "memory");
+      asm volatile ("rep stosb"
+                    : "+D" (dst), "+c" (tail) : "a" (word) : "memory");
+    }
 
   return dst_;
 }
@@ -296,8 +339,22 @@ strlen (const char *string)
 
   ASSERT (string != NULL);
 
-  for (p = string; *p != '\0'; p++)
-    continue;
+  /* Check bytes up to a word boundary, then whole words.  An
+     aligned word never crosses into the next page, so reading
+     past the null terminator within it cannot fault.  A word
+     contains a null byte if and only if subtracting 1 from each
+     byte borrows into the top bit of a byte that was clear. */
+  for (p = string; (uintptr_t) p & 3; p++)
+    if (*p == '\0')
+      return p - string;
+  for (;; p += 4) 
+    {
+      uint32_t word = *(const uword *) p;
+      if ((word - 0x01010101u) & ~word & 0x80808080u)
+        break;
+    }
+  while (*p != '\0')
+    p++;
   return p - string;
 }
 
@@ -373,3 +430,30 @@ strlcat (char *dst, const char *src, size_t size)
   return src_len + dst_len;
 }
 
+/* Copies SIZE bytes from SRC to DST, lowest address first, for
+   memcpy() and memmove().  DST may overlap the end of SRC, but
+   not its start. */
+static void
+copy_forward (unsigned char *dst, const unsigned char *src, size_t size) 
+{
+  if (size < SMALL_SIZE) 
+    {
+      for (; size >= 4; size -= 4, dst += 4, src += 4)
+        *(uword *) dst = *(const uword *) src;
+      while (size-- > 0)
+        *dst++ = *src++;
+    }
+  else 
+    {
+      size_t head = -(uintptr_t) dst & 3;
+      size_t word_cnt = (size - head) / 4;
+      size_t tail = (size - head) % 4;
+
+      asm volatile ("rep movsb"
+                    : "+D" (dst), "+S" (src), "+c" (head) : : "memory");
+      asm volatile ("rep movsl"
+                    : "+D" (dst), "+S" (src), "+c" (word_cnt) : : "memory");
+      asm volatile ("rep movsb"
+                    : "+D" (dst), "+S" (src), "+c" (tail) : : "memory");
+    }
+}
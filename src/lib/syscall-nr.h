@@ -1,6 +1,8 @@
 #ifndef __LIB_SYSCALL_NR_H
 #define __LIB_SYSCALL_NR_H
 
+#include <stdint.h>
+
 /* System call numbers. */
 enum 
   {
@@ -28,7 +30,28 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Kernel instrumentation. */
+    SYS_SCHEDSTAT,              /* Print scheduler statistics. */
+    SYS_LOCKSTAT,               /* Print lock statistics. */
+    SYS_SET_DEADLINE,           /* Join or leave the EDF class. */
+    SYS_PROFILE,                /* Start or stop the profiler. */
+    SYS_TRACE,                  /* Start or stop event tracing. */
+    SYS_GETRUSAGE,              /* Report CPU time used. */
+
+    /* User synchronization. */
+    SYS_FUTEX_WAIT,             /* Sleep if a word holds a value. */
+    SYS_FUTEX_WAKE              /* Wake threads sleeping on a word. */
+  };
+
+/* Resource usage of a process, as reported by SYS_GETRUSAGE. */
+struct rusage
+  {
+    uint64_t utime;             /* CPU time in user mode, in ns. */
+    uint64_t stime;             /* CPU time in the kernel, in ns. */
+    uint32_t nvcsw;             /* Switches away by blocking. */
+    uint32_t nivcsw;            /* Switches away while still ready. */
   };
 
 #endif /* lib/syscall-nr.h */
@@ -0,0 +1,114 @@
+#include <synch.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <syscall.h>
+
+/* The mutex is the three-state futex mutex from Ulrich Drepper,
+   "Futexes Are Tricky".  A thread that finds the mutex locked
+   sets its state to 2 before sleeping, so that the holder knows
+   to call futex_wake() when it unlocks.
+
+   futex_wait() returns -1 when no other thread could ever wake
+   its caller, as is always the case while a process has a single
+   thread.  Waiting then would hang the process, so mutex_lock()
+   and cond_wait() terminate it instead. */
+
+/* Initializes M as free. */
+void
+mutex_init (struct mutex *m)
+{
+  m->state = 0;
+}
+
+/* Locks M, sleeping until it is free if necessary.  Terminates
+   the process if no other thread could ever unlock M. */
+void
+mutex_lock (struct mutex *m)
+{
+  int c = 0;
+
+  if (__atomic_compare_exchange_n (&m->state, &c, 1, false,
+                                   __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return;
+
+  /* Contended.  Mark the mutex as having waiters, and sleep
+     until we are the ones to change it from free. */
+  if (c != 2)
+    c = __atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE);
+  while (c != 0)
+    {
+      if (futex_wait (&m->state, 2) < 0)
+        exit (-1);
+      c = __atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+/* Locks M if it is free.  Returns true if successful, false if
+   M was locked. */
+bool
+mutex_trylock (struct mutex *m)
+{
+  int c = 0;
+
+  return __atomic_compare_exchange_n (&m->state, &c, 1, false,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/* Unlocks M, which the caller must have locked, and wakes one
+   waiter if there may be any. */
+void
+mutex_unlock (struct mutex *m)
+{
+  if (__atomic_exchange_n (&m->state, 0, __ATOMIC_RELEASE) == 2)
+    futex_wake (&m->state, 1);
+}
+
+/* Initializes C with no waiters. */
+void
+cond_init (struct condition *c)
+{
+  c->seq = 0;
+  c->waiters = 0;
+}
+
+/* Atomically unlocks M and waits for C to be signaled, then
+   locks M again before returning.  M must be locked by the
+   caller.  As with any condition variable, the waiter may also
+   wake up without a signal and should recheck its condition.
+   Terminates the process if no other thread could ever signal
+   C. */
+void
+cond_wait (struct condition *c, struct mutex *m)
+{
+  int seq;
+
+  /* Counting ourselves before reading seq pairs with the signaler
+     bumping seq before reading waiters: either it sees us and
+     wakes us, or we see its signal and do not sleep. */
+  __atomic_fetch_add (&c->waiters, 1, __ATOMIC_SEQ_CST);
+  seq = __atomic_load_n (&c->seq, __ATOMIC_SEQ_CST);
+
+  mutex_unlock (m);
+  if (futex_wait (&c->seq, seq) < 0)
+    exit (-1);
+  __atomic_fetch_sub (&c->waiters, 1, __ATOMIC_SEQ_CST);
+  mutex_lock (m);
+}
+
+/* Wakes one thread waiting on C, if any. */
+void
+cond_signal (struct condition *c)
+{
+  __atomic_fetch_add (&c->seq, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&c->waiters, __ATOMIC_SEQ_CST) != 0)
+    futex_wake (&c->seq, 1);
+}
+
+/* Wakes all threads waiting on C. */
+void
+cond_broadcast (struct condition *c)
+{
+  __atomic_fetch_add (&c->seq, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&c->waiters, __ATOMIC_SEQ_CST) != 0)
+    futex_wake (&c->seq, INT_MAX);
+}
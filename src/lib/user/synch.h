@@ -0,0 +1,42 @@
+#ifndef __LIB_USER_SYNCH_H
+#define __LIB_USER_SYNCH_H
+
+#include <stdbool.h>
+
+/* Mutexes and condition variables for user programs, built on
+   the futex system calls.  Locking a free mutex, unlocking a
+   mutex that no one waits for, and signaling a condition that
+   no one waits on are done with atomic instructions alone,
+   without entering the kernel.  A wait that no other thread
+   could end terminates the process instead of hanging it. */
+
+/* A mutex. */
+struct mutex
+  {
+    int state;          /* 0: free, 1: locked, 2: locked, may have waiters. */
+  };
+
+/* Initializer for a free mutex. */
+#define MUTEX_INITIALIZER { 0 }
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+/* A condition variable. */
+struct condition
+  {
+    int seq;            /* Incremented by every signal. */
+    int waiters;        /* Number of threads in cond_wait(). */
+  };
+
+/* Initializer for a condition variable. */
+#define CONDITION_INITIALIZER { 0, 0 }
+
+void cond_init (struct condition *);
+void cond_wait (struct condition *, struct mutex *);
+void cond_signal (struct condition *);
+void cond_broadcast (struct condition *);
+
+#endif /* lib/user/synch.h */
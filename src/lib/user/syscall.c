@@ -183,3 +183,51 @@ inumber (int fd)
 {
   return syscall1 (SYS_INUMBER, fd);
 }
+
+void
+schedstat (void)
+{
+  syscall0 (SYS_SCHEDSTAT);
+}
+
+void
+lockstat (void)
+{
+  syscall0 (SYS_LOCKSTAT);
+}
+
+bool
+set_deadline (int period, int runtime)
+{
+  return syscall2 (SYS_SET_DEADLINE, period, runtime);
+}
+
+void
+profile (int interval)
+{
+  syscall1 (SYS_PROFILE, interval);
+}
+
+bool
+trace (unsigned mask)
+{
+  return syscall1 (SYS_TRACE, mask);
+}
+
+bool
+getrusage (struct rusage *usage)
+{
+  return syscall1 (SYS_GETRUSAGE, usage);
+}
+
+int
+futex_wait (int *addr, int val)
+{
+  return syscall2 (SYS_FUTEX_WAIT, addr, val);
+}
+
+int
+futex_wake (int *addr, int cnt)
+{
+  return syscall2 (SYS_FUTEX_WAKE, addr, cnt);
+}
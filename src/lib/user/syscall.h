@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <debug.h>
+#include <syscall-nr.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +46,16 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Kernel instrumentation. */
+void schedstat (void);
+void lockstat (void);
+bool set_deadline (int period, int runtime);
+void profile (int interval);
+bool trace (unsigned mask);
+bool getrusage (struct rusage *);
+
+/* User synchronization. */
+int futex_wait (int *addr, int val);
+int futex_wake (int *addr, int cnt);
+
 #endif /* lib/user/syscall.h */
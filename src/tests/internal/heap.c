@@ -0,0 +1,139 @@
+/* Test program for lib/kernel/heap.c.
+
+   Attempts to test the heap functionality that is not
+   sufficiently tested elsewhere in Pintos.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <heap.h>
+#include <random.h>
+#include <stdio.h>
+#include "threads/test.h"
+
+/* Maximum number of elements in a heap that we will test. */
+#define MAX_SIZE 64
+
+/* A heap element. */
+struct value 
+  {
+    struct heap_elem elem;      /* Heap element. */
+    int value;                  /* Item value. */
+    bool in_heap;               /* Currently in the heap? */
+  };
+
+static void shuffle (struct value[], size_t);
+static bool value_less (const struct heap_elem *, const struct heap_elem *,
+                        void *);
+static void verify_heap (struct heap *, struct value[], int size);
+
+/* Test the heap implementation. */
+void
+test (void) 
+{
+  int size;
+
+  printf ("testing various size heaps:");
+  for (size = 0; size < MAX_SIZE; size++) 
+    {
+      int repeat;
+
+      printf (" %d", size);
+      for (repeat = 0; repeat < 10; repeat++) 
+        {
+          static struct value values[MAX_SIZE];
+          struct heap heap;
+          int i;
+
+          /* Put values 0...SIZE in random order in VALUES and
+             push them. */
+          for (i = 0; i < size; i++)
+            values[i].value = i;
+          shuffle (values, size);
+          heap_init (&heap, value_less, NULL);
+          for (i = 0; i < size; i++)
+            {
+              heap_push (&heap, &values[i].elem);
+              values[i].in_heap = true;
+            }
+          ASSERT (heap_size (&heap) == (size_t) size);
+
+          /* Remove some elements from the middle. */
+          for (i = 0; i < size; i++)
+            if (random_ulong () % 4 == 0)
+              {
+                heap_remove (&heap, &values[i].elem);
+                values[i].in_heap = false;
+              }
+
+          /* Change some keys. */
+          for (i = 0; i < size; i++)
+            if (values[i].in_heap && random_ulong () % 4 == 0)
+              {
+                values[i].value = random_ulong () % (size * 2);
+                heap_update (&heap, &values[i].elem);
+              }
+
+          verify_heap (&heap, values, size);
+        }
+    }
+  
+  printf (" done\n");
+  printf ("heap: PASS\n");
+}
+
+/* Shuffles the CNT elements in ARRAY into random order. */
+static void
+shuffle (struct value *array, size_t cnt) 
+{
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    {
+      size_t j = i + random_ulong () % (cnt - i);
+      struct value t = array[j];
+      array[j] = array[i];
+      array[i] = t;
+    }
+}
+
+/* Returns true if value A is less than value B, false
+   otherwise. */
+static bool
+value_less (const struct heap_elem *a_, const struct heap_elem *b_,
+            void *aux UNUSED) 
+{
+  const struct value *a = heap_entry (a_, struct value, elem);
+  const struct value *b = heap_entry (b_, struct value, elem);
+  
+  return a->value < b->value;
+}
+
+/* Verifies that popping HEAP yields exactly the elements of the
+   SIZE-element array VALUES that are marked as in the heap, in
+   nonincreasing order, and leaves HEAP empty. */
+static void
+verify_heap (struct heap *heap, struct value values[], int size) 
+{
+  int expected = 0;
+  int prev = -1;
+  int i;
+
+  for (i = 0; i < size; i++)
+    if (values[i].in_heap)
+      expected++;
+  ASSERT (heap_size (heap) == (size_t) expected);
+
+  for (i = 0; i < expected; i++) 
+    {
+      struct value *v = heap_entry (heap_pop (heap), struct value, elem);
+      ASSERT (v->in_heap);
+      ASSERT (i == 0 || v->value <= prev);
+      prev = v->value;
+      v->in_heap = false;
+    }
+  ASSERT (heap_empty (heap));
+}
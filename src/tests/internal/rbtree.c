@@ -0,0 +1,193 @@
+/* Test program for lib/kernel/rbtree.c.
+
+   Attempts to test the red-black tree functionality that is not
+   sufficiently tested elsewhere in Pintos.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <rbtree.h>
+#include <random.h>
+#include <stdio.h>
+#include "threads/test.h"
+
+/* Maximum number of elements in a tree that we will test. */
+#define MAX_SIZE 64
+
+/* A tree element. */
+struct value
+  {
+    struct rb_elem elem;        /* Tree element. */
+    int value;                  /* Item value. */
+    int seq;                    /* Order of insertion. */
+    bool in_tree;               /* Currently in the tree? */
+  };
+
+static void shuffle (struct value[], size_t);
+static bool value_less (const struct rb_elem *, const struct rb_elem *,
+                        void *);
+static int verify_subtree (const struct rb_elem *);
+static void verify_tree (struct rbtree *, struct value[], int size);
+
+/* Test the red-black tree implementation. */
+void
+test (void)
+{
+  int size;
+
+  printf ("testing various size trees:");
+  for (size = 0; size < MAX_SIZE; size++)
+    {
+      int repeat;
+
+      printf (" %d", size);
+      for (repeat = 0; repeat < 10; repeat++)
+        {
+          static struct value values[MAX_SIZE];
+          struct rbtree tree;
+          int i;
+
+          /* Put values 0...SIZE/2 in random order in VALUES, so
+             that most values occur twice, and insert them. */
+          for (i = 0; i < size; i++)
+            values[i].value = i / 2;
+          shuffle (values, size);
+          rbtree_init (&tree, value_less, NULL);
+          for (i = 0; i < size; i++)
+            {
+              values[i].seq = i;
+              rbtree_insert (&tree, &values[i].elem);
+              values[i].in_tree = true;
+            }
+          ASSERT (rbtree_size (&tree) == (size_t) size);
+          verify_subtree (tree.root);
+
+          /* Remove some elements from the middle. */
+          for (i = 0; i < size; i++)
+            if (random_ulong () % 4 == 0)
+              {
+                rbtree_remove (&tree, &values[i].elem);
+                values[i].in_tree = false;
+                verify_subtree (tree.root);
+              }
+
+          /* Change some keys. */
+          for (i = 0; i < size; i++)
+            if (values[i].in_tree && random_ulong () % 4 == 0)
+              {
+                rbtree_remove (&tree, &values[i].elem);
+                values[i].value = random_ulong () % size;
+                values[i].seq = size + i;
+                rbtree_insert (&tree, &values[i].elem);
+              }
+
+          verify_tree (&tree, values, size);
+        }
+    }
+
+  printf (" done\n");
+  printf ("rbtree: PASS\n");
+}
+
+/* Shuffles the CNT elements in ARRAY into random order. */
+static void
+shuffle (struct value *array, size_t cnt)
+{
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    {
+      size_t j = i + random_ulong () % (cnt - i);
+      struct value t = array[j];
+      array[j] = array[i];
+      array[i] = t;
+    }
+}
+
+/* Returns true if value A is less than value B, false
+   otherwise. */
+static bool
+value_less (const struct rb_elem *a_, const struct rb_elem *b_,
+            void *aux UNUSED)
+{
+  const struct value *a = rbtree_entry (a_, struct value, elem);
+  const struct value *b = rbtree_entry (b_, struct value, elem);
+
+  return a->value < b->value;
+}
+
+/* Verifies the red-black properties and parent pointers of the
+   subtree rooted at E and returns its black height. */
+static int
+verify_subtree (const struct rb_elem *e)
+{
+  int left, right;
+
+  if (e == NULL)
+    return 1;
+  if (e->parent == NULL)
+    ASSERT (!e->red);
+  if (e->red)
+    ASSERT ((e->left == NULL || !e->left->red)
+            && (e->right == NULL || !e->right->red));
+  if (e->left != NULL)
+    ASSERT (e->left->parent == e);
+  if (e->right != NULL)
+    ASSERT (e->right->parent == e);
+
+  left = verify_subtree (e->left);
+  right = verify_subtree (e->right);
+  ASSERT (left == right);
+  return left + !e->red;
+}
+
+/* Verifies that TREE is a valid red-black tree holding exactly
+   the elements of the SIZE-element array VALUES that are marked
+   as in the tree, that walking it forward and backward yields
+   them in order, with equal values in order of insertion, and
+   that removing its least element repeatedly empties it. */
+static void
+verify_tree (struct rbtree *tree, struct value values[], int size)
+{
+  struct rb_elem *e;
+  int expected = 0;
+  int cnt;
+  int i;
+
+  for (i = 0; i < size; i++)
+    if (values[i].in_tree)
+      expected++;
+  ASSERT (rbtree_size (tree) == (size_t) expected);
+  verify_subtree (tree->root);
+
+  cnt = 0;
+  for (e = rbtree_min (tree); e != NULL; e = rbtree_next (e))
+    {
+      struct value *v = rbtree_entry (e, struct value, elem);
+      struct rb_elem *prev = rbtree_prev (e);
+      ASSERT (v->in_tree);
+      if (prev != NULL)
+        {
+          struct value *p = rbtree_entry (prev, struct value, elem);
+          ASSERT (p->value < v->value
+                  || (p->value == v->value && p->seq < v->seq));
+        }
+      else
+        ASSERT (cnt == 0);
+      cnt++;
+    }
+  ASSERT (cnt == expected);
+  ASSERT (expected == 0 || rbtree_next (rbtree_max (tree)) == NULL);
+
+  for (i = 0; i < expected; i++)
+    {
+      struct value *v = rbtree_entry (rbtree_min (tree), struct value, elem);
+      rbtree_remove (tree, &v->elem);
+      v->in_tree = false;
+    }
+  ASSERT (rbtree_empty (tree));
+  ASSERT (rbtree_min (tree) == NULL);
+}
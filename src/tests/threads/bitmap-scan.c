@@ -0,0 +1,100 @@
+/* Measures bitmap_scan() over a large, fragmented bitmap: one
+   bit per page of a 1 GB swap device, as vm/swap.c keeps it,
+   with only about one slot in eight free, scattered at random.
+   Reports the average cycles per scan for runs of 1, 8 and 32
+   free slots, and for bitmap_count() over the whole bitmap.
+
+   Each scan is also done a bit at a time, the way bitmap_scan()
+   used to work, to check the answers and for comparison, and the
+   count is checked against bitmap_test(). */
+
+#include <bitmap.h>
+#include <inttypes.h>
+#include <random.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/tsc.h"
+#include "threads/vaddr.h"
+
+#define BIT_CNT ((1024 * 1024 * 1024) / PGSIZE)  /* Pages in 1 GB. */
+#define SCAN_CNT 16             /* Scans per run length. */
+
+static size_t slow_scan (const struct bitmap *, size_t start, size_t cnt,
+                         bool value);
+
+void
+test_bitmap_scan (void) 
+{
+  static const size_t run_lengths[] = {1, 8, 32};
+  struct bitmap *b = bitmap_create (BIT_CNT);
+  uint64_t start, cycles;
+  size_t free_cnt, i;
+
+  if (b == NULL)
+    fail ("bitmap_create of %d bits failed", BIT_CNT);
+
+  /* True bits are free slots. */
+  random_init (0);
+  for (i = 0; i < BIT_CNT; i++)
+    bitmap_set (b, i, random_ulong () % 8 == 0);
+
+  for (i = 0; i < sizeof run_lengths / sizeof *run_lengths; i++)
+    {
+      size_t cnt = run_lengths[i];
+      uint64_t fast_cycles = 0, slow_cycles = 0;
+      int j;
+
+      for (j = 0; j < SCAN_CNT; j++)
+        {
+          size_t from = random_ulong () % BIT_CNT;
+          size_t fast, slow;
+
+          start = rdtsc ();
+          fast = bitmap_scan (b, from, cnt, true);
+          fast_cycles += rdtsc () - start;
+
+          start = rdtsc ();
+          slow = slow_scan (b, from, cnt, true);
+          slow_cycles += rdtsc () - start;
+
+          if (fast != slow)
+            fail ("scan for %zu free slots from %zu found %zu, expected %zu",
+                  cnt, from, fast, slow);
+        }
+      msg ("scan for %zu free: %"PRIu64" cycles per scan, "
+           "%"PRIu64" a bit at a time", cnt, fast_cycles / SCAN_CNT,
+           slow_cycles / SCAN_CNT);
+    }
+
+  start = rdtsc ();
+  free_cnt = bitmap_count (b, 0, BIT_CNT, true);
+  cycles = rdtsc () - start;
+  msg ("count: %"PRIu64" cycles for %zu free of %d", cycles, free_cnt,
+       BIT_CNT);
+  for (i = 0; i < BIT_CNT; i++)
+    free_cnt -= bitmap_test (b, i);
+  if (free_cnt != 0)
+    fail ("bitmap_count was off by %zu", free_cnt);
+  msg ("scans and count agree with bit-at-a-time versions");
+
+  bitmap_destroy (b);
+}
+
+/* Returns the first group of CNT bits in B at or after START
+   that are all VALUE, or BITMAP_ERROR, testing one bit at a
+   time. */
+static size_t
+slow_scan (const struct bitmap *b, size_t start, size_t cnt, bool value) 
+{
+  size_t i, j;
+
+  for (i = start; i + cnt <= bitmap_size (b); i++)
+    {
+      for (j = 0; j < cnt; j++)
+        if (bitmap_test (b, i + j) != value)
+          break;
+      if (j == cnt)
+        return i;
+    }
+  return BITMAP_ERROR;
+}
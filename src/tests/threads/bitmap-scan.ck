@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# The test compares each answer with a bit-at-a-time version and
+# says so once all of them agree.  The timings themselves are not
+# checked, since they depend on the simulator.
+foreach my $re (qr/^\(bitmap-scan\) scan for 1 free: \d+ cycles per scan, \d+ a bit at a time$/,
+		qr/^\(bitmap-scan\) scan for 8 free: \d+ cycles per scan, \d+ a bit at a time$/,
+		qr/^\(bitmap-scan\) scan for 32 free: \d+ cycles per scan, \d+ a bit at a time$/,
+		qr/^\(bitmap-scan\) count: \d+ cycles for \d+ free of 262144$/,
+		qr/^\(bitmap-scan\) scans and count agree with bit-at-a-time versions$/) {
+    fail "missing output matching $re\n" if !grep (/$re/, @output);
+}
+pass;
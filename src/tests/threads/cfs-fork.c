@@ -0,0 +1,85 @@
+/* Checks that a thread created while others are running gets
+   only its fair share of the CPU under the completely fair
+   scheduler, rather than running ahead of them.
+
+   Two threads spin for 15 seconds.  5 seconds in, a third
+   starts spinning for the remaining 10 seconds.  All three have
+   nice 0, so the first two should receive about 250 + 333 = 583
+   of the 1,500 ticks each, and the third about 333.  A new
+   thread that started at a vruntime of 0 would instead run alone
+   until it had caught up, for about 250 ticks, and receive about
+   500. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 3
+
+struct thread_info 
+  {
+    int64_t start_time;
+    int64_t spin_start;
+    int tick_count;
+  };
+
+static void load_thread (void *aux);
+
+void
+test_cfs_fork (void) 
+{
+  struct thread_info info[THREAD_CNT];
+  int64_t start_time;
+  int i;
+
+  ASSERT (thread_cfs);
+
+  start_time = timer_ticks ();
+  msg ("Starting %d threads...", THREAD_CNT - 1);
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      struct thread_info *ti = &info[i];
+
+      ti->start_time = start_time;
+      ti->spin_start = (i < THREAD_CNT - 1 ? 3 : 8) * TIMER_FREQ;
+      ti->tick_count = 0;
+    }
+  for (i = 0; i < THREAD_CNT - 1; i++) 
+    {
+      char name[16];
+
+      snprintf (name, sizeof name, "load %d", i);
+      thread_create (name, PRI_DEFAULT, load_thread, &info[i]);
+    }
+
+  msg ("Letting them run 5 seconds before starting another...");
+  timer_sleep (8 * TIMER_FREQ - timer_elapsed (start_time));
+  thread_create ("load 2", PRI_DEFAULT, load_thread, &info[THREAD_CNT - 1]);
+
+  msg ("Sleeping 15 seconds to let threads run, please wait...");
+  timer_sleep (20 * TIMER_FREQ - timer_elapsed (start_time));
+
+  for (i = 0; i < THREAD_CNT; i++)
+    msg ("Thread %d received %d ticks.", i, info[i].tick_count);
+}
+
+static void
+load_thread (void *ti_) 
+{
+  struct thread_info *ti = ti_;
+  int64_t spin_time = 18 * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  timer_sleep (ti->spin_start - timer_elapsed (ti->start_time));
+  while (timer_elapsed (ti->start_time) < spin_time) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ti->tick_count++;
+      last_time = cur_time;
+    }
+}
@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::mlfqs;
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+my (@actual);
+local ($_);
+foreach (@output) {
+    my ($id, $count) = /Thread (\d+) received (\d+) ticks\./ or next;
+    $actual[$id] = $count;
+}
+
+# Two threads share 500 ticks, then three share 1,000.  A new
+# thread that ran ahead would get about 500.
+my (@expected) = (583, 583, 333);
+
+mlfqs_compare ("thread", "%d", \@actual, \@expected, 50, [0, $#expected, 1],
+	       "Some tick counts were missing or differed from those "
+	       . "expected by more than 50.");
+pass;
@@ -0,0 +1,28 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::mlfqs;
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+my (@actual);
+local ($_);
+foreach (@output) {
+    my ($id, $count) = /Thread (\d+) received (\d+) ticks\./ or next;
+    $actual[$id] = $count;
+}
+
+# Weights of nice 0, 5 and 10, sharing 2,000 ticks.
+my (@weight) = (1024, 335, 110);
+my ($total) = 0;
+$total += $_ foreach @weight;
+my (@expected) = map ($_ * 2000 / $total, @weight);
+
+mlfqs_compare ("thread", "%d", \@actual, \@expected, 50, [0, $#weight, 1],
+	       "Some tick counts were missing or differed from those "
+	       . "expected by more than 50.");
+pass;
@@ -0,0 +1,52 @@
+/* Checks admission control for the EDF scheduling class: a
+   thread may join it only with a runtime between 1 and its
+   period, and only while the EDF threads together reserve no
+   more than 95% of the CPU.  Bandwidth is given back when a
+   thread leaves the class. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func child_thread;
+static void try_deadline (const char *who, int period, int runtime);
+
+void
+test_edf_admission (void) 
+{
+  struct semaphore done;
+
+  try_deadline ("main", 10, 5);
+  try_deadline ("main", 10, 11);
+
+  sema_init (&done, 0);
+  thread_create ("child", PRI_DEFAULT, child_thread, &done);
+  sema_down (&done);
+
+  try_deadline ("main", 10, 9);
+  try_deadline ("main", 0, 0);
+}
+
+static void
+child_thread (void *done_) 
+{
+  struct semaphore *done = done_;
+
+  try_deadline ("child", 10, 5);
+  try_deadline ("child", 10, 4);
+  try_deadline ("child", 0, 0);
+  sema_up (done);
+}
+
+/* Asks for RUNTIME ticks in every PERIOD and reports whether
+   the request was admitted. */
+static void
+try_deadline (const char *who, int period, int runtime) 
+{
+  bool ok = thread_set_deadline (period, runtime);
+
+  msg ("%s: runtime %d per period %d %s.",
+       who, runtime, period, ok ? "accepted" : "rejected");
+}
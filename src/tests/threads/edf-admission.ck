@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-admission) begin
+(edf-admission) main: runtime 5 per period 10 accepted.
+(edf-admission) main: runtime 11 per period 10 rejected.
+(edf-admission) child: runtime 5 per period 10 rejected.
+(edf-admission) child: runtime 4 per period 10 accepted.
+(edf-admission) child: runtime 0 per period 0 accepted.
+(edf-admission) main: runtime 9 per period 10 accepted.
+(edf-admission) main: runtime 0 per period 0 accepted.
+(edf-admission) end
+EOF
+pass;
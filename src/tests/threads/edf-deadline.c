@@ -0,0 +1,162 @@
+/* Runs periodic EDF tasks next to an EDF thread that tries to
+   use more CPU time than it reserved and two CPU-bound threads
+   of high priority, and checks that every job of the periodic
+   tasks finishes by its deadline.
+
+   Each periodic task reserves 5 ticks in every 25 and releases a
+   job of about 2 ticks of work at the start of each period; the
+   job's deadline is the end of that period.  The hog reserves 6
+   ticks in every 20 but never blocks, so it is throttled each
+   time its budget runs out.  Together the EDF threads reserve
+   90% of the CPU, so the priority threads still get to run. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define TASK_CNT 3              /* Periodic tasks. */
+#define JOB_CNT 10              /* Jobs per task. */
+#define PERIOD 25               /* Period of the tasks, in ticks. */
+#define RUNTIME 5               /* Reserved time per period. */
+#define JOB_TICKS 2             /* Work per job. */
+
+struct edf_test
+  {
+    int64_t start;              /* Release of the first jobs. */
+    unsigned loops_per_tick;    /* Spins in one tick of CPU time. */
+    struct semaphore done;      /* Upped by each thread at exit. */
+    int missed;                 /* Deadlines missed, all tasks. */
+    volatile bool stop;         /* Tells the hogs to exit. */
+    unsigned long hog_loops;    /* Work done by the priority hogs. */
+  };
+
+static thread_func periodic_thread, edf_hog_thread, priority_hog_thread;
+static unsigned calibrate (void);
+static void spin (unsigned loops);
+
+void
+test_edf_deadline (void) 
+{
+  struct edf_test test;
+  int i;
+
+  /* This test relies on priority scheduling. */
+  ASSERT (!thread_mlfqs);
+
+  thread_set_priority (PRI_MAX);
+
+  test.loops_per_tick = calibrate ();
+  sema_init (&test.done, 0);
+  test.missed = 0;
+  test.stop = false;
+  test.hog_loops = 0;
+  test.start = timer_ticks () + 10;
+
+  for (i = 0; i < TASK_CNT; i++)
+    thread_create ("periodic", PRI_DEFAULT, periodic_thread, &test);
+  thread_create ("edf hog", PRI_DEFAULT, edf_hog_thread, &test);
+  for (i = 0; i < 2; i++)
+    thread_create ("priority hog", PRI_MAX - 1, priority_hog_thread, &test);
+
+  for (i = 0; i < TASK_CNT; i++)
+    sema_down (&test.done);
+  test.stop = true;
+  for (i = 0; i < 3; i++)
+    sema_down (&test.done);
+
+  msg ("%d periodic tasks, %d jobs: %d deadlines missed.",
+       TASK_CNT, TASK_CNT * JOB_CNT, test.missed);
+  if (test.hog_loops > 0)
+    msg ("Priority threads ran alongside the EDF threads.");
+  else
+    msg ("Priority threads were starved.");
+}
+
+/* Releases JOB_CNT jobs, one per period, and counts those that
+   finish after the end of their period. */
+static void
+periodic_thread (void *test_) 
+{
+  struct edf_test *test = test_;
+  int job;
+
+  if (!thread_set_deadline (PERIOD, RUNTIME))
+    fail ("periodic task not admitted");
+
+  for (job = 0; job < JOB_CNT; job++) 
+    {
+      int64_t release = test->start + job * PERIOD;
+      enum intr_level old_level;
+
+      if (timer_ticks () < release)
+        timer_sleep (release - timer_ticks ());
+      spin (test->loops_per_tick * JOB_TICKS);
+      if (timer_ticks () > release + PERIOD) 
+        {
+          old_level = intr_disable ();
+          test->missed++;
+          intr_set_level (old_level);
+        }
+    }
+  sema_up (&test->done);
+}
+
+/* Runs for as long as the EDF class lets it. */
+static void
+edf_hog_thread (void *test_) 
+{
+  struct edf_test *test = test_;
+
+  if (!thread_set_deadline (20, 6))
+    fail ("EDF hog not admitted");
+  while (!test->stop)
+    continue;
+  sema_up (&test->done);
+}
+
+/* Counts the time it gets to run. */
+static void
+priority_hog_thread (void *test_) 
+{
+  struct edf_test *test = test_;
+
+  while (!test->stop)
+    {
+      enum intr_level old_level = intr_disable ();
+      test->hog_loops++;
+      intr_set_level (old_level);
+    }
+  sema_up (&test->done);
+}
+
+/* Returns the number of spin() loops that take one timer tick,
+   averaged over a few ticks. */
+static unsigned
+calibrate (void) 
+{
+  unsigned loops = 0;
+  int64_t start;
+
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    continue;
+  start = timer_ticks ();
+  while (timer_ticks () < start + 4)
+    {
+      spin (1000);
+      loops += 1000;
+    }
+  return loops / 4;
+}
+
+/* Spins for LOOPS iterations. */
+static void
+spin (unsigned loops) 
+{
+  while (loops-- > 0)
+    barrier ();
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-deadline) begin
+(edf-deadline) 3 periodic tasks, 30 jobs: 0 deadlines missed.
+(edf-deadline) Priority threads ran alongside the EDF threads.
+(edf-deadline) end
+EOF
+pass;
@@ -0,0 +1,124 @@
+/* Measures the page allocator under churn: a mix of single-page
+   and multi-page allocations from the user pool, freed in random
+   order, as malloc's big blocks and bitmap buffers would be.
+   Reports the average cycles per palloc_get_multiple() and
+   palloc_free_multiple() call and how fragmented the pool is at
+   the end of the churn, then frees everything and checks that
+   the pool coalesces back to its starting state.
+
+   Each allocation is tagged with its slot number, and the tags
+   are checked when it is freed, to catch overlapping
+   allocations. */
+
+#include <inttypes.h>
+#include <random.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/palloc.h"
+#include "threads/tsc.h"
+#include "threads/vaddr.h"
+
+#define SLOT_CNT 32             /* Allocations live at once, at most. */
+#define MAX_PAGES 8             /* Largest allocation, in pages. */
+#define ROUND_CNT 4096          /* Allocations or frees. */
+
+struct slot
+  {
+    uint8_t *pages;             /* Allocated pages, or null. */
+    size_t page_cnt;            /* Number of pages. */
+  };
+
+static void tag (struct slot *, unsigned id);
+static void check_tag (const struct slot *, unsigned id);
+
+void
+test_palloc_churn (void) 
+{
+  static struct slot slots[SLOT_CNT];
+  size_t free_before = palloc_free_cnt (PAL_USER);
+  size_t largest_before = palloc_largest_free (PAL_USER);
+  uint64_t get_cycles = 0, free_cycles = 0;
+  unsigned get_cnt = 0, free_cnt = 0;
+  int i;
+
+  random_init (0);
+  for (i = 0; i < ROUND_CNT; i++)
+    {
+      unsigned id = random_ulong () % SLOT_CNT;
+      struct slot *s = &slots[id];
+      uint64_t start;
+
+      if (s->pages != NULL)
+        {
+          check_tag (s, id);
+          start = rdtsc ();
+          palloc_free_multiple (s->pages, s->page_cnt);
+          free_cycles += rdtsc () - start;
+          free_cnt++;
+          s->pages = NULL;
+        }
+      else
+        {
+          /* Half the allocations are single pages. */
+          s->page_cnt = random_ulong () % 2 ? 1
+                        : random_ulong () % MAX_PAGES + 1;
+          start = rdtsc ();
+          s->pages = palloc_get_multiple (PAL_USER, s->page_cnt);
+          get_cycles += rdtsc () - start;
+          get_cnt++;
+          if (s->pages == NULL)
+            fail ("palloc_get_multiple of %zu pages failed", s->page_cnt);
+          tag (s, id);
+        }
+    }
+
+  msg ("palloc_get_multiple: %"PRIu64" cycles per call",
+       get_cycles / get_cnt);
+  msg ("palloc_free_multiple: %"PRIu64" cycles per call",
+       free_cycles / free_cnt);
+  msg ("after churn: largest free block %zu of %zu free pages",
+       palloc_largest_free (PAL_USER), palloc_free_cnt (PAL_USER));
+
+  for (i = 0; i < SLOT_CNT; i++)
+    if (slots[i].pages != NULL)
+      {
+        check_tag (&slots[i], i);
+        palloc_free_multiple (slots[i].pages, slots[i].page_cnt);
+        slots[i].pages = NULL;
+      }
+  if (palloc_free_cnt (PAL_USER) != free_before
+      || palloc_largest_free (PAL_USER) != largest_before)
+    fail ("pool did not coalesce: largest free block %zu of %zu free pages, "
+          "expected %zu of %zu", palloc_largest_free (PAL_USER),
+          palloc_free_cnt (PAL_USER), largest_before, free_before);
+  msg ("freed pages coalesced");
+}
+
+/* Writes ID and the page number into the start of each of S's
+   pages. */
+static void
+tag (struct slot *s, unsigned id) 
+{
+  size_t i;
+
+  for (i = 0; i < s->page_cnt; i++)
+    {
+      unsigned *p = (unsigned *) (s->pages + i * PGSIZE);
+      p[0] = id;
+      p[1] = i;
+    }
+}
+
+/* Checks the tags written by tag(). */
+static void
+check_tag (const struct slot *s, unsigned id) 
+{
+  size_t i;
+
+  for (i = 0; i < s->page_cnt; i++)
+    {
+      const unsigned *p = (const unsigned *) (s->pages + i * PGSIZE);
+      if (p[0] != id || p[1] != i)
+        fail ("page %zu of slot %u was overwritten", i, id);
+    }
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Cycle counts and fragmentation vary with the pool size and
+# from run to run, so only check that they were measured.
+foreach my $re (qr/^\(palloc-churn\) palloc_get_multiple: \d+ cycles per call$/,
+		qr/^\(palloc-churn\) palloc_free_multiple: \d+ cycles per call$/,
+		qr/^\(palloc-churn\) after churn: largest free block \d+ of \d+ free pages$/,
+		qr/^\(palloc-churn\) freed pages coalesced$/) {
+    fail "missing output matching $re\n" if !grep (/$re/, @output);
+}
+pass;
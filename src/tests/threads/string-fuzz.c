@@ -0,0 +1,205 @@
+/* Checks memcpy(), memmove(), memset(), memcmp() and strlen()
+   against simple byte-at-a-time versions, for random sizes from
+   0 bytes to a page, at random alignments, and for memmove()
+   with the blocks overlapping in either direction.
+
+   Each function's results are applied to a working buffer and,
+   through the reference version, to a copy of it.  The two are
+   compared over the block and a margin on either side, which
+   catches bytes written outside the block. */
+
+#include <random.h>
+#include <stdint.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+#define CASE_CNT 1000           /* Cases per function. */
+#define MARGIN 64               /* Bytes checked around each block. */
+#define BUF_PAGES 3             /* Size of each buffer. */
+
+static uint8_t *src;            /* Random source bytes. */
+static uint8_t *work;           /* Updated by the functions tested. */
+static uint8_t *expected;       /* Updated by the references. */
+
+static size_t random_size (void);
+static size_t random_ofs (void);
+static void check (const char *function, size_t ofs, size_t size);
+static void ref_copy (uint8_t *dst, const uint8_t *src, size_t size);
+static void ref_move (uint8_t *dst, const uint8_t *src, size_t size);
+static int ref_cmp (const uint8_t *a, const uint8_t *b, size_t size);
+static int sign (int);
+
+void
+test_string_fuzz (void)
+{
+  int i;
+
+  src = palloc_get_multiple (PAL_ASSERT, BUF_PAGES);
+  work = palloc_get_multiple (PAL_ASSERT, BUF_PAGES);
+  expected = palloc_get_multiple (PAL_ASSERT, BUF_PAGES);
+  random_init (0);
+  random_bytes (src, BUF_PAGES * PGSIZE);
+  random_bytes (work, BUF_PAGES * PGSIZE);
+  ref_copy (expected, work, BUF_PAGES * PGSIZE);
+
+  for (i = 0; i < CASE_CNT; i++)
+    {
+      size_t size = random_size ();
+      size_t from = random_ofs (), to = random_ofs ();
+
+      if (memcpy (work + to, src + from, size) != work + to)
+        fail ("memcpy returned the wrong pointer");
+      ref_copy (expected + to, src + from, size);
+      check ("memcpy", to, size);
+    }
+  msg ("memcpy: %d cases", CASE_CNT);
+
+  for (i = 0; i < CASE_CNT; i++)
+    {
+      /* Move within the buffer by up to MARGIN bytes either way,
+         so that the blocks usually overlap. */
+      size_t size = random_size ();
+      size_t from = random_ofs ();
+      size_t to = from + random_ulong () % (2 * MARGIN + 1) - MARGIN;
+
+      if (memmove (work + to, work + from, size) != work + to)
+        fail ("memmove returned the wrong pointer");
+      ref_move (expected + to, expected + from, size);
+      check ("memmove", to < from ? to : from, size + MARGIN);
+    }
+  msg ("memmove: %d cases", CASE_CNT);
+
+  for (i = 0; i < CASE_CNT; i++)
+    {
+      size_t size = random_size ();
+      size_t ofs = random_ofs ();
+      int value = random_ulong () % 256;
+      size_t j;
+
+      if (memset (work + ofs, value, size) != work + ofs)
+        fail ("memset returned the wrong pointer");
+      for (j = 0; j < size; j++)
+        expected[ofs + j] = value;
+      check ("memset", ofs, size);
+    }
+  msg ("memset: %d cases", CASE_CNT);
+
+  for (i = 0; i < CASE_CNT; i++)
+    {
+      /* Compare a copy of SRC, with one bit flipped half of the
+         time, against SRC. */
+      size_t size = random_size ();
+      size_t from = random_ofs (), ofs = random_ofs ();
+      int result;
+
+      ref_copy (work + ofs, src + from, size);
+      if (size > 0 && random_ulong () % 2)
+        work[ofs + random_ulong () % size] ^= 1 << random_ulong () % 8;
+      ref_copy (expected + ofs, work + ofs, size);
+
+      result = memcmp (work + ofs, src + from, size);
+      if (sign (result) != ref_cmp (work + ofs, src + from, size))
+        fail ("memcmp of %zu bytes at offsets %zu and %zu returned %d",
+              size, ofs, from, result);
+    }
+  msg ("memcmp: %d cases", CASE_CNT);
+
+  for (i = 0; i < CASE_CNT; i++)
+    {
+      size_t length = random_size () % PGSIZE;
+      size_t ofs = random_ofs ();
+      size_t j, result;
+
+      for (j = 0; j < length; j++)
+        work[ofs + j] = src[j] | 1;
+      work[ofs + length] = '\0';
+      ref_copy (expected + ofs, work + ofs, length + 1);
+
+      result = strlen ((const char *) work + ofs);
+      if (result != length)
+        fail ("strlen of %zu bytes at offset %zu returned %zu",
+              length, ofs, result);
+    }
+  msg ("strlen: %d cases", CASE_CNT);
+
+  palloc_free_multiple (src, BUF_PAGES);
+  palloc_free_multiple (work, BUF_PAGES);
+  palloc_free_multiple (expected, BUF_PAGES);
+}
+
+/* Returns a random block size from 0 bytes to a page, favoring
+   small sizes. */
+static size_t
+random_size (void)
+{
+  switch (random_ulong () % 4)
+    {
+    case 0:
+      return random_ulong () % 16;
+    case 1:
+      return random_ulong () % 128;
+    default:
+      return random_ulong () % (PGSIZE + 1);
+    }
+}
+
+/* Returns a random offset into a buffer for a block of up to a
+   page, leaving MARGIN bytes on either side. */
+static size_t
+random_ofs (void)
+{
+  return 2 * MARGIN + random_ulong () % (PGSIZE - 2 * MARGIN);
+}
+
+/* Fails if the SIZE bytes at OFS in the working buffer, or the
+   MARGIN bytes around them, differ from the expected ones. */
+static void
+check (const char *function, size_t ofs, size_t size)
+{
+  size_t i;
+
+  for (i = ofs - MARGIN; i < ofs + size + MARGIN; i++)
+    if (work[i] != expected[i])
+      fail ("%s of %zu bytes at offset %zu: byte %zu is %#x, expected %#x",
+            function, size, ofs, i, work[i], expected[i]);
+}
+
+/* Copies SIZE bytes from SRC to DST, a byte at a time. */
+static void
+ref_copy (uint8_t *dst, const uint8_t *src, size_t size)
+{
+  while (size-- > 0)
+    *dst++ = *src++;
+}
+
+/* Copies SIZE bytes from SRC to DST, which may overlap, a byte
+   at a time. */
+static void
+ref_move (uint8_t *dst, const uint8_t *src, size_t size)
+{
+  if (dst < src)
+    ref_copy (dst, src, size);
+  else
+    while (size-- > 0)
+      dst[size] = src[size];
+}
+
+/* Compares the SIZE bytes at A and B a byte at a time, returning
+   -1, 0 or 1. */
+static int
+ref_cmp (const uint8_t *a, const uint8_t *b, size_t size)
+{
+  for (; size-- > 0; a++, b++)
+    if (*a != *b)
+      return *a > *b ? 1 : -1;
+  return 0;
+}
+
+/* Returns -1, 0 or 1 for a negative, zero or positive X. */
+static int
+sign (int x)
+{
+  return (x > 0) - (x < 0);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(string-fuzz) begin
+(string-fuzz) memcpy: 1000 cases
+(string-fuzz) memmove: 1000 cases
+(string-fuzz) memset: 1000 cases
+(string-fuzz) memcmp: 1000 cases
+(string-fuzz) strlen: 1000 cases
+(string-fuzz) end
+EOF
+pass;
@@ -0,0 +1,140 @@
+/* Measures memcpy(), memset(), memcmp() and strlen() on blocks
+   of 1 byte to a page, in powers of 2.  The blocks start on page
+   boundaries, except for a final page copied between buffers
+   that are misaligned with each other.  Reports the average
+   cycles per call, and checks the result of each last call.
+   string-fuzz checks the functions more thoroughly. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/palloc.h"
+#include "threads/tsc.h"
+#include "threads/vaddr.h"
+
+#define BYTE_CNT (256 * 1024)   /* Bytes to process per measurement. */
+#define MIN_CALLS 64            /* Calls per measurement, at least. */
+
+static uint8_t *a, *b;
+
+static uint64_t time_memcpy (size_t size, size_t a_ofs, size_t b_ofs);
+static uint64_t time_memset (size_t size);
+static uint64_t time_memcmp (size_t size);
+static uint64_t time_strlen (size_t size);
+static int call_cnt (size_t size);
+
+void
+test_string_speed (void)
+{
+  size_t size;
+
+  /* Two pages each, for strlen()'s null terminator and the
+     misaligned copy. */
+  a = palloc_get_multiple (PAL_ASSERT | PAL_ZERO, 2);
+  b = palloc_get_multiple (PAL_ASSERT | PAL_ZERO, 2);
+
+  for (size = 1; size <= PGSIZE; size *= 2)
+    {
+      uint64_t copy = time_memcpy (size, 0, 0);
+      uint64_t set = time_memset (size);
+      uint64_t cmp = time_memcmp (size);
+      uint64_t len = time_strlen (size);
+
+      msg ("%4zu bytes: memcpy %"PRIu64", memset %"PRIu64", "
+           "memcmp %"PRIu64", strlen %"PRIu64" cycles",
+           size, copy, set, cmp, len);
+    }
+  msg ("%4d bytes misaligned: memcpy %"PRIu64" cycles",
+       PGSIZE, time_memcpy (PGSIZE, 1, 3));
+  msg ("all results correct");
+
+  palloc_free_multiple (a, 2);
+  palloc_free_multiple (b, 2);
+}
+
+/* Returns the average cycles to copy SIZE bytes from B + B_OFS
+   to A + A_OFS. */
+static uint64_t
+time_memcpy (size_t size, size_t a_ofs, size_t b_ofs)
+{
+  int cnt = call_cnt (size);
+  uint64_t start, cycles;
+  size_t j;
+  int i;
+
+  for (j = 0; j < size; j++)
+    b[b_ofs + j] = j * 7 + 1;
+  start = rdtsc ();
+  for (i = 0; i < cnt; i++)
+    memcpy (a + a_ofs, b + b_ofs, size);
+  cycles = (rdtsc () - start) / cnt;
+
+  for (j = 0; j < size; j++)
+    if (a[a_ofs + j] != b[b_ofs + j])
+      fail ("memcpy of %zu bytes got byte %zu wrong", size, j);
+  return cycles;
+}
+
+/* Returns the average cycles to fill SIZE bytes. */
+static uint64_t
+time_memset (size_t size)
+{
+  int cnt = call_cnt (size);
+  uint64_t start = rdtsc ();
+  uint64_t cycles;
+  size_t j;
+  int i;
+
+  for (i = 0; i < cnt; i++)
+    memset (a, i, size);
+  cycles = (rdtsc () - start) / cnt;
+
+  for (j = 0; j < size; j++)
+    if (a[j] != (uint8_t) (cnt - 1))
+      fail ("memset of %zu bytes got byte %zu wrong", size, j);
+  return cycles;
+}
+
+/* Returns the average cycles to compare SIZE equal bytes. */
+static uint64_t
+time_memcmp (size_t size)
+{
+  int cnt = call_cnt (size);
+  uint64_t start;
+  int i;
+
+  memset (a, 'x', size);
+  memset (b, 'x', size);
+  start = rdtsc ();
+  for (i = 0; i < cnt; i++)
+    if (memcmp (a, b, size) != 0)
+      fail ("memcmp of %zu equal bytes returned nonzero", size);
+  return (rdtsc () - start) / cnt;
+}
+
+/* Returns the average cycles to find the length of a string of
+   SIZE bytes. */
+static uint64_t
+time_strlen (size_t size)
+{
+  int cnt = call_cnt (size);
+  uint64_t start;
+  int i;
+
+  memset (a, 'x', size);
+  a[size] = '\0';
+  start = rdtsc ();
+  for (i = 0; i < cnt; i++)
+    if (strlen ((const char *) a) != size)
+      fail ("strlen of %zu bytes returned the wrong length", size);
+  return (rdtsc () - start) / cnt;
+}
+
+/* Returns the number of calls to time for blocks of SIZE
+   bytes. */
+static int
+call_cnt (size_t size)
+{
+  return BYTE_CNT / size > MIN_CALLS ? BYTE_CNT / size : MIN_CALLS;
+}
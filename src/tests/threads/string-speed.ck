@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# Any cycle counts are accepted, as long as every size was
+# measured and the results were right.
+my (@res);
+for (my $size = 1; $size <= 4096; $size *= 2) {
+    push (@res, qr/^\(string-speed\)\s+$size bytes: memcpy \d+, memset \d+, memcmp \d+, strlen \d+ cycles$/);
+}
+push (@res, qr/^\(string-speed\) 4096 bytes misaligned: memcpy \d+ cycles$/);
+push (@res, qr/^\(string-speed\) all results correct$/);
+foreach my $re (@res) {
+    fail "missing output matching $re\n" if !grep (/$re/, @output);
+}
+pass;
@@ -38,6 +38,15 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"thread-create-rate", test_thread_create_rate},
+    {"edf-admission", test_edf_admission},
+    {"edf-deadline", test_edf_deadline},
+    {"cfs-nice", test_cfs_nice},
+    {"cfs-fork", test_cfs_fork},
+    {"palloc-churn", test_palloc_churn},
+    {"bitmap-scan", test_bitmap_scan},
+    {"string-fuzz", test_string_fuzz},
+    {"string-speed", test_string_speed},
   };
 
 static const char *test_name;
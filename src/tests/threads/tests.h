@@ -32,6 +32,15 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_thread_create_rate;
+extern test_func test_edf_admission;
+extern test_func test_edf_deadline;
+extern test_func test_cfs_nice;
+extern test_func test_cfs_fork;
+extern test_func test_palloc_churn;
+extern test_func test_bitmap_scan;
+extern test_func test_string_fuzz;
+extern test_func test_string_speed;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
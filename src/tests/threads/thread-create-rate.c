@@ -0,0 +1,115 @@
+/* Measures how quickly threads can be created and exit, first
+   with the cache of dead threads' pages turned off, so that
+   every thread gets a freshly allocated and zeroed page, and
+   then with it turned on.
+
+   Each thread runs at a higher priority than the test, so it
+   runs and exits as soon as it is created and its page is free
+   again before the next thread is created.
+
+   Finally checks that an exited thread can no longer be found
+   by its tid, and that with the cache on, a new thread gets the
+   page of the thread that exited just before it. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/tsc.h"
+
+#define THREAD_CNT 256
+
+/* A thread created by run_child(). */
+struct child
+  {
+    struct semaphore done;      /* Upped by the thread when it runs. */
+    struct thread *self;        /* The thread's struct thread. */
+  };
+
+static thread_func exit_thread;
+static thread_func record_thread;
+static uint64_t measure (void);
+static struct thread *run_child (void);
+
+void
+test_thread_create_rate (void) 
+{
+  bool cache_enabled = thread_cache_enabled;
+
+  /* This test relies on priority scheduling. */
+  ASSERT (!thread_mlfqs);
+
+  thread_cache_enabled = false;
+  msg ("thread cache off: %"PRIu64" cycles per thread", measure ());
+  thread_cache_enabled = true;
+  msg ("thread cache on: %"PRIu64" cycles per thread", measure ());
+
+  if (run_child () != run_child ())
+    fail ("new thread did not get the page of the thread that exited "
+          "before it");
+  msg ("exited threads leave the tid table and their pages are reused");
+
+  thread_cache_enabled = cache_enabled;
+}
+
+/* Creates THREAD_CNT threads one after another and returns the
+   average number of cycles from creating a thread until it has
+   exited. */
+static uint64_t
+measure (void) 
+{
+  struct semaphore done;
+  uint64_t start;
+  int i;
+
+  sema_init (&done, 0);
+  start = rdtsc ();
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      if (thread_create ("rate", PRI_DEFAULT + 1, exit_thread, &done)
+          == TID_ERROR)
+        fail ("thread_create failed after %d threads", i);
+      sema_down (&done);
+    }
+  return (rdtsc () - start) / THREAD_CNT;
+}
+
+static void
+exit_thread (void *done_) 
+{
+  struct semaphore *done = done_;
+
+  sema_up (done);
+}
+
+/* Creates a thread, waits for it to exit and checks that its tid
+   is gone from the tid table.  Returns the thread's former
+   struct thread, which by then is no longer in use. */
+static struct thread *
+run_child (void) 
+{
+  struct child child;
+  tid_t tid;
+
+  sema_init (&child.done, 0);
+  tid = thread_create ("child", PRI_DEFAULT + 1, record_thread, &child);
+  if (tid == TID_ERROR)
+    fail ("thread_create failed");
+  sema_down (&child.done);
+
+  /* The child was freed when it switched back to us. */
+  if (thread_find (tid) != NULL)
+    fail ("thread %d still in the tid table after exiting", tid);
+  return child.self;
+}
+
+static void
+record_thread (void *child_) 
+{
+  struct child *child = child_;
+
+  child->self = thread_current ();
+  sema_up (&child->done);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+# The timings depend on the simulator, so accept any cycle count,
+# but the page reuse check must have passed.
+foreach my $mode ('off', 'on') {
+    fail "missing measurement with thread cache $mode\n"
+      if !grep (/^\(thread-create-rate\) thread cache $mode: \d+ cycles per thread$/,
+		@output);
+}
+fail "page reuse check did not complete\n"
+  if !grep ($_ eq '(thread-create-rate) exited threads leave the tid table and their pages are reused', @output);
+pass;
@@ -0,0 +1,19 @@
+/* Waits on a condition variable that no other thread could ever
+   signal.  cond_wait() must terminate the process with a -1 exit
+   code instead of hanging it. */
+
+#include <synch.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct mutex m = MUTEX_INITIALIZER;
+  struct condition c = CONDITION_INITIALIZER;
+
+  mutex_lock (&m);
+  msg ("wait with no signaler");
+  cond_wait (&c, &m);
+  fail ("should have exited with -1");
+}
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-cond) begin
+(futex-cond) wait with no signaler
+futex-cond: exit(-1)
+EOF
+pass;
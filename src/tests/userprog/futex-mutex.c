@@ -0,0 +1,30 @@
+/* Locks and unlocks a mutex that no other thread wants, and
+   signals a condition that no thread waits on.  None of these
+   may mark the mutex as having waiters, which would make
+   mutex_unlock() enter the kernel. */
+
+#include <synch.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct mutex m = MUTEX_INITIALIZER;
+  struct condition c;
+
+  CHECK (mutex_trylock (&m), "trylock a free mutex");
+  CHECK (!mutex_trylock (&m), "trylock a locked mutex fails");
+  CHECK (m.state == 1, "locked mutex has no waiters");
+  mutex_unlock (&m);
+  CHECK (m.state == 0, "unlock frees it");
+
+  mutex_lock (&m);
+  CHECK (m.state == 1, "lock a free mutex");
+  cond_init (&c);
+  cond_signal (&c);
+  cond_broadcast (&c);
+  CHECK (c.waiters == 0 && m.state == 1, "signal with no waiters");
+  mutex_unlock (&m);
+  CHECK (m.state == 0, "unlock frees it");
+}
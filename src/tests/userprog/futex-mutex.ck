@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-mutex) begin
+(futex-mutex) trylock a free mutex
+(futex-mutex) trylock a locked mutex fails
+(futex-mutex) locked mutex has no waiters
+(futex-mutex) unlock frees it
+(futex-mutex) lock a free mutex
+(futex-mutex) signal with no waiters
+(futex-mutex) unlock frees it
+(futex-mutex) end
+futex-mutex: exit(0)
+EOF
+pass;
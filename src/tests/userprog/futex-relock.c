@@ -0,0 +1,18 @@
+/* Locks a mutex that the process already holds.  No other thread
+   could ever unlock it, so mutex_lock() must terminate the
+   process with a -1 exit code instead of hanging it. */
+
+#include <synch.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct mutex m = MUTEX_INITIALIZER;
+
+  mutex_lock (&m);
+  msg ("lock a free mutex");
+  mutex_lock (&m);
+  fail ("should have exited with -1");
+}
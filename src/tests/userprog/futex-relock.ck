@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-relock) begin
+(futex-relock) lock a free mutex
+futex-relock: exit(-1)
+EOF
+pass;
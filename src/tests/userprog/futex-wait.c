@@ -0,0 +1,19 @@
+/* Calls futex_wait() with values that the word does and does not
+   hold.  With no other thread to wake the caller, it must return
+   at once in both cases, -1 if it would have had to sleep, and
+   leave the word alone. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word = 1;
+
+void
+test_main (void) 
+{
+  CHECK (futex_wait (&word, 0) == 0, "futex_wait with a different value");
+  CHECK (futex_wait (&word, -1) == 0, "futex_wait with another value");
+  CHECK (futex_wait (&word, 1) == -1, "futex_wait with the same value");
+  CHECK (word == 1, "word is unchanged");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-wait) begin
+(futex-wait) futex_wait with a different value
+(futex-wait) futex_wait with another value
+(futex-wait) futex_wait with the same value
+(futex-wait) word is unchanged
+(futex-wait) end
+futex-wait: exit(0)
+EOF
+pass;
@@ -0,0 +1,20 @@
+/* Checks the counts that futex_wake() returns when no thread is
+   waiting: 0, however many it is asked to wake, including after
+   a futex_wait() that returned at once. */
+
+#include <limits.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word;
+
+void
+test_main (void) 
+{
+  CHECK (futex_wake (&word, 1) == 0, "futex_wake of 1 wakes none");
+  CHECK (futex_wake (&word, INT_MAX) == 0, "futex_wake of all wakes none");
+  CHECK (futex_wake (&word, 0) == 0, "futex_wake of 0 wakes none");
+  CHECK (futex_wait (&word, 1) == 0, "futex_wait with a different value");
+  CHECK (futex_wake (&word, 1) == 0, "futex_wake of 1 still wakes none");
+}
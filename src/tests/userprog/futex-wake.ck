@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-wake) begin
+(futex-wake) futex_wake of 1 wakes none
+(futex-wake) futex_wake of all wakes none
+(futex-wake) futex_wake of 0 wakes none
+(futex-wake) futex_wait with a different value
+(futex-wake) futex_wake of 1 still wakes none
+(futex-wake) end
+futex-wake: exit(0)
+EOF
+pass;
@@ -0,0 +1,33 @@
+/* Child process of page-lend.  Runs itself to the depth given by
+   its argument, so that that many processes are alive at once,
+   and exits with the depth. */
+
+#include <debug.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+int
+main (int argc UNUSED, char *argv[]) 
+{
+  int n = atoi (argv[1]);
+
+  test_name = "child-lend";
+
+  if (n > 1) 
+    {
+      char cmd[32];
+      pid_t child;
+      int code;
+
+      snprintf (cmd, sizeof cmd, "child-lend %d", n - 1);
+      child = exec (cmd);
+      if (child == -1)
+        fail ("exec \"%s\" failed", cmd);
+      code = wait (child);
+      if (code != n - 1)
+        fail ("wait for \"%s\" returned %d", cmd, code);
+    }
+  return n;
+}
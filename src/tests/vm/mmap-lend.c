@@ -0,0 +1,82 @@
+/* Fills 2 MB of memory, as page-lend does, so that the pages of
+   a file mapped afterward are borrowed from the shared pool.
+   Then, while a chain of child-lend processes brings the shared
+   pool below its low watermark so that lent pages are
+   reclaimed, read()s sample.txt into every page of the mapping
+   again and again.  Each read() holds the file system locks
+   while it copies into a mapped page that may be in the middle
+   of being reclaimed.  Checks that every exec succeeds and that
+   the mapping, and the file once it is unmapped, hold the data
+   that was read. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (2 * 1024 * 1024)
+#define CHILD_DEPTH 30
+#define MAP_PAGES 16
+#define ROUNDS 8
+
+static char buf[SIZE];
+static char page[4096];
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  size_t len = strlen (sample);
+  char cmd[32];
+  int handle, sample_fd;
+  mapid_t map;
+  pid_t child;
+  size_t i;
+  int round;
+
+  msg ("initialize");
+  for (i = 0; i < SIZE; i++)
+    buf[i] = i % 251;
+
+  CHECK (create ("lend.dat", MAP_PAGES * 4096), "create \"lend.dat\"");
+  CHECK ((handle = open ("lend.dat")) > 1, "open \"lend.dat\"");
+  CHECK ((map = mmap (handle, actual)) != MAP_FAILED, "mmap \"lend.dat\"");
+  CHECK ((sample_fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  snprintf (cmd, sizeof cmd, "child-lend %d", CHILD_DEPTH);
+  CHECK ((child = exec (cmd)) != -1, "exec \"%s\"", cmd);
+
+  msg ("read into mapping");
+  for (round = 0; round < ROUNDS; round++)
+    for (i = 0; i < MAP_PAGES; i++)
+      {
+        seek (sample_fd, 0);
+        if (read (sample_fd, actual + i * 4096, len) != (int) len)
+          fail ("read of \"sample.txt\" into page %zu failed", i);
+      }
+  CHECK (wait (child) == CHILD_DEPTH, "wait for child");
+
+  msg ("check mapping");
+  for (i = 0; i < MAP_PAGES; i++)
+    if (memcmp (actual + i * 4096, sample, len))
+      fail ("page %zu of mapping has bad data", i);
+  munmap (map);
+  close (sample_fd);
+
+  msg ("check file");
+  for (i = 0; i < MAP_PAGES; i++)
+    {
+      if (read (handle, page, sizeof page) != (int) sizeof page)
+        fail ("read of page %zu of \"lend.dat\" failed", i);
+      if (memcmp (page, sample, len))
+        fail ("page %zu of \"lend.dat\" has bad data", i);
+    }
+  close (handle);
+
+  msg ("read pass");
+  for (i = 0; i < SIZE; i++)
+    if (buf[i] != (char) (i % 251))
+      fail ("byte %zu is %d, expected %d", i, buf[i], (char) (i % 251));
+}
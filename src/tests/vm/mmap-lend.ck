@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-lend) begin
+(mmap-lend) initialize
+(mmap-lend) create "lend.dat"
+(mmap-lend) open "lend.dat"
+(mmap-lend) mmap "lend.dat"
+(mmap-lend) open "sample.txt"
+(mmap-lend) exec "child-lend 30"
+(mmap-lend) read into mapping
+(mmap-lend) wait for child
+(mmap-lend) check mapping
+(mmap-lend) check file
+(mmap-lend) read pass
+(mmap-lend) end
+EOF
+pass;
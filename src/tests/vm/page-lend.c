@@ -0,0 +1,40 @@
+/* Fills 2 MB of memory, more than the user pool holds, so that
+   some of it is borrowed from the shared pool, then runs a chain
+   of CHILD_DEPTH processes that are all alive at once.  Their
+   threads, page directories and file descriptor tables are
+   kernel pages, and with the default 4 MB of RAM they outgrow
+   the kernel pool and bring the shared pool below its low
+   watermark, so lent pages are reclaimed while this process and
+   the chain wait.  Checks that every exec succeeds and that the
+   2 MB comes back intact. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (2 * 1024 * 1024)
+#define CHILD_DEPTH 30
+
+static char buf[SIZE];
+
+void
+test_main (void)
+{
+  char cmd[32];
+  pid_t child;
+  size_t i;
+
+  msg ("initialize");
+  for (i = 0; i < SIZE; i++)
+    buf[i] = i % 251;
+
+  snprintf (cmd, sizeof cmd, "child-lend %d", CHILD_DEPTH);
+  CHECK ((child = exec (cmd)) != -1, "exec \"%s\"", cmd);
+  CHECK (wait (child) == CHILD_DEPTH, "wait for child");
+
+  msg ("read pass");
+  for (i = 0; i < SIZE; i++)
+    if (buf[i] != (char) (i % 251))
+      fail ("byte %zu is %d, expected %d", i, buf[i], (char) (i % 251));
+}
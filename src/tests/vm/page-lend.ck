@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-lend) begin
+(page-lend) initialize
+(page-lend) exec "child-lend 30"
+(page-lend) wait for child
+(page-lend) read pass
+(page-lend) end
+EOF
+pass;
@@ -63,4 +63,18 @@ int fp_div_int(int x, int n){
     return x / n;
 }
 
+/* x raised to the n-th power, by repeated squaring */
+static inline int
+fp_pow_int (int x, int n)
+{
+    int result = FP_1;
+
+    for (; n > 0; n >>= 1) {
+        if (n & 1)
+            result = fp_mul(result, x);
+        x = fp_mul(x, x);
+    }
+    return result;
+}
+
 //#endif /* threads/fp_arithm.h */
\ No newline at end of file
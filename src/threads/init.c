@@ -21,7 +21,10 @@
 #include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/profile.h"
+#include "threads/trace.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -55,9 +58,12 @@ static const char *swap_bdev_name;
 #endif
 #endif /* FILESYS */
 
-/* -ul: Maximum number of pages to put into palloc's user pool. */
+/* -ul: Maximum number of pages palloc gives to user pages. */
 static size_t user_page_limit = SIZE_MAX;
 
+/* -trace: Events to trace from boot. */
+static uint32_t trace_boot_mask;
+
 static void bss_init (void);
 static void paging_init (void);
 
@@ -65,6 +71,7 @@ static char **read_command_line (void);
 static char **parse_options (char **argv);
 static void run_actions (char **argv);
 static void usage (void);
+static int parse_count (const char *name, const char *value);
 
 #ifdef FILESYS
 static void locate_block_devices (void);
@@ -99,6 +106,7 @@ main (void)
   palloc_init (user_page_limit);
   malloc_init ();
   paging_init ();
+  trace_init (trace_boot_mask);
 
   /* Segmentation. */
 #ifdef USERPROG
@@ -118,6 +126,9 @@ main (void)
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
+  workqueue_init ();
+  if (poolstat_enabled)
+    palloc_stat_start ();
   serial_init_queue ();
   timer_calibrate ();
 
@@ -128,8 +139,11 @@ main (void)
   filesys_init (format_filesys);
 #endif
 
+#ifdef VM
+  page_init ();
   lru_list_init();
   swap_init ();
+#endif
 
   printf ("Boot complete.\n");
   
@@ -260,13 +274,30 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-cfs"))
+        thread_cfs = true;
+      else if (!strcmp (name, "-tickless"))
+        timer_tickless = true;
+      else if (!strcmp (name, "-lockstat"))
+        lockstat_enabled = true;
+      else if (!strcmp (name, "-intrstat"))
+        intrstat_enabled = true;
+      else if (!strcmp (name, "-poolstat"))
+        poolstat_enabled = true;
+      else if (!strcmp (name, "-profile"))
+        profile_start (value != NULL ? parse_count (name, value) : 1);
+      else if (!strcmp (name, "-trace"))
+        trace_boot_mask = (value != NULL ? (uint32_t) atoi (value)
+                           : (1u << TRACE_EVENT_CNT) - 1);
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
-        user_page_limit = atoi (value);
+        user_page_limit = parse_count (name, value);
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
     }
+  if (thread_mlfqs && thread_cfs)
+    PANIC ("-mlfqs and -cfs cannot be used together");
 
   /* Initialize the random number generator based on the system
      time.  This has no effect if an "-rs" option was specified.
@@ -347,6 +378,32 @@ run_actions (char **argv)
   
 }
 
+/* Returns VALUE, the argument to option NAME, as a positive
+   integer.  Prints the help message and powers off if VALUE is
+   missing, is not a decimal number, or is zero. */
+static int
+parse_count (const char *name, const char *value)
+{
+  const char *p;
+  int count = 0;
+  bool ok = value != NULL && *value != '\0';
+
+  for (p = value; ok && *p != '\0'; p++)
+    {
+      int digit = *p - '0';
+      ok = digit >= 0 && digit <= 9 && count <= (INT_MAX - digit) / 10;
+      if (ok)
+        count = count * 10 + digit;
+    }
+  if (ok && count > 0)
+    return count;
+
+  printf ("%s: expected a positive number, not `%s'\n",
+          name, value != NULL ? value : "");
+  usage ();
+  NOT_REACHED ();
+}
+
 /* Prints a kernel command line help message and powers off the
    machine. */
 static void
@@ -383,6 +440,13 @@ usage (void)
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -cfs               Use completely fair scheduler.\n"
+          "  -tickless          Stop the periodic timer tick while idle.\n"
+          "  -lockstat          Collect lock contention statistics.\n"
+          "  -intrstat          Time interrupt handlers and interrupts-off code.\n"
+          "  -poolstat          Sample page pool occupancy every second.\n"
+          "  -profile[=N]       Sample the running code every N timer ticks.\n"
+          "  -trace[=MASK]      Trace the events in MASK (default all).\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -7,6 +7,7 @@
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
 #include "threads/thread.h"
+#include "threads/tsc.h"
 #include "threads/vaddr.h"
 #include "devices/timer.h"
 
@@ -47,6 +48,42 @@ static unsigned int unexpected_cnt[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* Interrupt statistics.  If enabled, the time spent in each
+   interrupt's handler is counted in a histogram with a bucket
+   for each power of 2 cycles, and the longest sections of code
+   that ran with interrupts off are kept with the places where
+   interrupts were turned off and back on. */
+bool intrstat_enabled;
+
+#define INTR_HIST_SHIFT 8       /* Bucket 0 is under 2**8 cycles. */
+#define INTR_HIST_BUCKETS 16    /* The last bucket is open-ended. */
+
+/* Handler time statistics for one interrupt vector. */
+struct intr_stat
+  {
+    unsigned cnt;                       /* Number of calls. */
+    uint64_t total;                     /* Total cycles. */
+    uint64_t max;                       /* Longest call. */
+    unsigned hist[INTR_HIST_BUCKETS];   /* Calls by duration. */
+  };
+static struct intr_stat intr_stats[INTR_CNT];
+
+/* A stretch of time with interrupts off. */
+struct irqsoff_section
+  {
+    uint64_t cycles;            /* Duration. */
+    void *disabled_at;          /* Where interrupts were turned off. */
+    void *enabled_at;           /* Where they were turned back on. */
+  };
+
+/* The longest interrupts-off sections, longest first, at most
+   one for each pair of sites. */
+static struct irqsoff_section irqsoff_top[INTRSTAT_TOP];
+
+/* Current interrupts-off section, if irqsoff_start is nonzero. */
+static uint64_t irqsoff_start;  /* When interrupts were turned off. */
+static void *irqsoff_site;      /* Where interrupts were turned off. */
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -59,6 +96,12 @@ static inline uint64_t make_idtr_operand (uint16_t limit, void *base);
 /* Interrupt handlers. */
 void intr_handler (struct intr_frame *args);
 static void unexpected_interrupt (const struct intr_frame *);
+
+/* Interrupt statistics helpers. */
+static enum intr_level enable (void *site);
+static enum intr_level disable (void *site);
+static void irqsoff_end (void *site);
+static void intr_stat_add (uint8_t vec_no, uint64_t cycles);
 
 /* Returns the current interrupt status. */
 enum intr_level
@@ -80,16 +123,35 @@ intr_get_level (void)
 enum intr_level
 intr_set_level (enum intr_level level) 
 {
-  return level == INTR_ON ? intr_enable () : intr_disable ();
+  void *site = __builtin_return_address (0);
+  return level == INTR_ON ? enable (site) : disable (site);
 }
 
 /* Enables interrupts and returns the previous interrupt status. */
 enum intr_level
 intr_enable (void) 
+{
+  return enable (__builtin_return_address (0));
+}
+
+/* Disables interrupts and returns the previous interrupt status. */
+enum intr_level
+intr_disable (void) 
+{
+  return disable (__builtin_return_address (0));
+}
+
+/* Enables interrupts and returns the previous interrupt status.
+   SITE is the caller's caller, for statistics. */
+static enum intr_level
+enable (void *site) 
 {
   enum intr_level old_level = intr_get_level ();
   ASSERT (!intr_context ());
 
+  if (old_level == INTR_OFF && irqsoff_start != 0)
+    irqsoff_end (site);
+
   /* Enable interrupts by setting the interrupt flag.
 
      See [IA32-v2b] "STI" and [IA32-v3a] 5.8.1 "Masking Maskable
@@ -99,9 +161,10 @@ intr_enable (void)
   return old_level;
 }
 
-/* Disables interrupts and returns the previous interrupt status. */
-enum intr_level
-intr_disable (void) 
+/* Disables interrupts and returns the previous interrupt status.
+   SITE is the caller's caller, for statistics. */
+static enum intr_level
+disable (void *site) 
 {
   enum intr_level old_level = intr_get_level ();
 
@@ -110,6 +173,12 @@ intr_disable (void)
      Hardware Interrupts". */
   asm volatile ("cli" : : : "memory");
 
+  if (old_level == INTR_ON && intrstat_enabled)
+    {
+      irqsoff_start = rdtsc ();
+      irqsoff_site = site;
+    }
+
   return old_level;
 }
 
@@ -346,6 +415,7 @@ intr_handler (struct intr_frame *frame)
 {
   bool external;
   intr_handler_func *handler;
+  uint64_t start = intrstat_enabled ? rdtsc () : 0;
 
   /* External interrupts are special.
      We only handle one at a time (so interrupts must be off)
@@ -359,8 +429,19 @@ intr_handler (struct intr_frame *frame)
 
       in_external_intr = true;
       yield_on_return = false;
+
+      /* The interrupted code had interrupts on, and the CPU
+         turned them off to call us. */
+      if (start != 0)
+        {
+          irqsoff_start = start;
+          irqsoff_site = intr_handlers[frame->vec_no];
+        }
     }
 
+  /* Charge the interrupted thread for the time until now. */
+  thread_account ((frame->cs & 3) == 3);
+
   /* Invoke the interrupt's handler. */
   handler = intr_handlers[frame->vec_no];
   if (handler != NULL)
@@ -374,6 +455,9 @@ intr_handler (struct intr_frame *frame)
   else
     unexpected_interrupt (frame);
 
+  if (start != 0)
+    intr_stat_add (frame->vec_no, rdtsc () - start);
+
   /* Complete the processing of an external interrupt. */
   if (external) 
     {
@@ -383,11 +467,20 @@ intr_handler (struct intr_frame *frame)
       in_external_intr = false;
       pic_end_of_interrupt (frame->vec_no); 
 
+      /* Returning turns interrupts back on, but yielding keeps
+         them off until the next thread turns them on. */
+      if (irqsoff_start != 0 && !yield_on_return)
+        irqsoff_end (intr_handlers[frame->vec_no]);
+
       if (yield_on_return)
       {
         thread_yield();
       }       
     }
+
+  /* The time in the handler was spent in the kernel. */
+  if ((frame->cs & 3) == 3)
+    thread_account (false);
 }
 
 /* Handles an unexpected interrupt with interrupt frame F.  An
@@ -432,6 +525,94 @@ intr_dump_frame (const struct intr_frame *f)
           f->cs, f->ds, f->es, f->ss);
 }
 
+/* Ends the current interrupts-off section at SITE and keeps it
+   if it is one of the longest.  Interrupts must be off. */
+static void
+irqsoff_end (void *site)
+{
+  struct irqsoff_section s;
+  int i;
+
+  s.cycles = rdtsc () - irqsoff_start;
+  s.disabled_at = irqsoff_site;
+  s.enabled_at = site;
+  irqsoff_start = 0;
+
+  /* Drop a shorter section between the same sites. */
+  for (i = 0; i < INTRSTAT_TOP; i++)
+    if (irqsoff_top[i].disabled_at == s.disabled_at
+        && irqsoff_top[i].enabled_at == s.enabled_at)
+      {
+        if (irqsoff_top[i].cycles >= s.cycles)
+          return;
+        for (; i + 1 < INTRSTAT_TOP; i++)
+          irqsoff_top[i] = irqsoff_top[i + 1];
+        irqsoff_top[i].cycles = 0;
+        irqsoff_top[i].disabled_at = irqsoff_top[i].enabled_at = NULL;
+        break;
+      }
+
+  /* Insert S in order. */
+  for (i = 0; i < INTRSTAT_TOP; i++)
+    if (s.cycles > irqsoff_top[i].cycles)
+      {
+        struct irqsoff_section t = irqsoff_top[i];
+        irqsoff_top[i] = s;
+        s = t;
+      }
+}
+
+/* Counts a call of CYCLES to the handler for VEC_NO. */
+static void
+intr_stat_add (uint8_t vec_no, uint64_t cycles)
+{
+  struct intr_stat *st = &intr_stats[vec_no];
+  int bucket = 0;
+
+  while (bucket + 1 < INTR_HIST_BUCKETS
+         && cycles >> (bucket + INTR_HIST_SHIFT) != 0)
+    bucket++;
+
+  st->cnt++;
+  st->total += cycles;
+  if (cycles > st->max)
+    st->max = cycles;
+  st->hist[bucket]++;
+}
+
+/* Prints the interrupt statistics: the longest interrupts-off
+   sections and, for each interrupt that was handled, a
+   histogram of its handler's running time. */
+void
+intrstat_print (void)
+{
+  int i, vec;
+
+  printf ("Interrupts off (cycles), longest %d:\n", INTRSTAT_TOP);
+  for (i = 0; i < INTRSTAT_TOP && irqsoff_top[i].cycles != 0; i++)
+    printf (" %10"PRIu64" off at %p, on at %p\n", irqsoff_top[i].cycles,
+            irqsoff_top[i].disabled_at, irqsoff_top[i].enabled_at);
+
+  for (vec = 0; vec < INTR_CNT; vec++)
+    {
+      const struct intr_stat *st = &intr_stats[vec];
+      int bucket;
+
+      if (st->cnt == 0)
+        continue;
+      printf ("Interrupt %#04x (%s): %u calls, avg %"PRIu64", max %"PRIu64
+              " cycles\n", vec, intr_names[vec], st->cnt,
+              st->total / st->cnt, st->max);
+      for (bucket = 0; bucket < INTR_HIST_BUCKETS; bucket++)
+        if (st->hist[bucket] != 0)
+          printf (" %s2^%d: %u\n",
+                  bucket + 1 < INTR_HIST_BUCKETS ? "<" : ">=",
+                  bucket + INTR_HIST_SHIFT
+                  - (bucket + 1 < INTR_HIST_BUCKETS ? 0 : 1),
+                  st->hist[bucket]);
+    }
+}
+
 /* Returns the name of interrupt VEC. */
 const char *
 intr_name (uint8_t vec) 
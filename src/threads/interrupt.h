@@ -67,4 +67,9 @@ void intr_yield_on_return (void);
 void intr_dump_frame (const struct intr_frame *);
 const char *intr_name (uint8_t vec);
 
+/* Interrupt statistics. */
+#define INTRSTAT_TOP 10         /* Interrupts-off sections to keep. */
+extern bool intrstat_enabled;
+void intrstat_print (void);
+
 #endif /* threads/interrupt.h */
@@ -41,6 +41,8 @@ struct desc
     size_t blocks_per_arena;    /* Number of blocks in an arena. */
     struct list free_list;      /* List of free blocks. */
     struct lock lock;           /* Lock. */
+    struct lock_class lock_class; /* Statistics for `lock'. */
+    char name[16];              /* Name of `lock_class'. */
   };
 
 /* Magic number for detecting arena corruption. */
@@ -80,7 +82,9 @@ malloc_init (void)
       d->block_size = block_size;
       d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
       list_init (&d->free_list);
-      lock_init (&d->lock);
+      snprintf (d->name, sizeof d->name, "malloc %zu", block_size);
+      lock_class_init (&d->lock_class, d->name);
+      lock_init_class (&d->lock, &d->lock_class);
     }
 }
 
@@ -1,47 +1,139 @@
 #include "threads/palloc.h"
-#include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
-#include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "threads/workqueue.h"
 
 /* Page allocator.  Hands out memory in page-size (or
    page-multiple) chunks.  See malloc.h for an allocator that
    hands out smaller chunks.
 
-   System memory is divided into two "pools" called the kernel
-   and user pools.  The user pool is for user (virtual) memory
-   pages, the kernel pool for everything else.  The idea here is
-   that the kernel needs to have memory for its own operations
-   even if user processes are swapping like mad.
+   System memory is divided into three "pools" called the
+   kernel, user and shared pools.  User (virtual) memory pages
+   come from the user pool, everything else from the kernel
+   pool, and either kind of allocation that does not fit in its
+   own pool borrows from the shared pool.  The idea here is that
+   the kernel needs to have memory for its own operations even
+   if user processes are swapping like mad, but a fixed split
+   leaves memory idle in one pool while the other runs short.
 
-   By default, half of system RAM is given to the kernel pool and
-   half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   A quarter of system RAM is given to each of the kernel and
+   user pools and the rest to the shared pool.  Two watermarks
+   keep the shared pool from being swallowed by user pages:
 
-/* A memory pool. */
+     - User pages are not lent out of the shared pool if that
+       would leave fewer than its low watermark free, so the
+       kernel can always count on its own pool plus the low
+       watermark.
+
+     - When kernel allocations bring the shared pool below its
+       low watermark, pages lent to user allocations are
+       reclaimed in the background, through the function that
+       palloc_set_reclaim() registered, until the pool is back
+       above its high watermark.
+
+   Each pool is a binary buddy allocator.  Free memory is kept in
+   blocks of 2**ORDER pages, aligned to their size relative to
+   the start of the pool, on a free list for each order.  A
+   request is served from the smallest block that is large
+   enough, splitting larger blocks in halves ("buddies") as
+   needed, and a freed block is merged with its buddy whenever
+   the buddy is free too.  A request for a number of pages that
+   is not a power of 2 gives back the unused tail of its block,
+   so it ties up no more pages than it asked for. */
+
+/* Number of block orders.  A pool of more than 2**(ORDER_CNT-1)
+   pages is divided into several blocks of the largest order. */
+#define ORDER_CNT 20
+
+/* State of a page, in a pool's page_state array: the order of
+   the free block that starts there, or one of these. */
+#define PAGE_USED 0xff                  /* Allocated. */
+#define PAGE_FREE 0xfe                  /* Free, not first in its block. */
+#define PAGE_LENT 0xfd                  /* Allocated to a user page
+                                           from the shared pool. */
+
+/* A memory pool.
+
+   A pool is protected by turning interrupts off, not by a lock,
+   because thread_schedule_tail() frees a dying thread's page in
+   the middle of a thread switch, where nothing may sleep.  The
+   buddy updates made with interrupts off are short: at most
+   ORDER_CNT splits or merges per block. */
 struct pool
   {
-    struct lock lock;                   /* Mutual exclusion. */
-    struct bitmap *used_map;            /* Bitmap of free pages. */
+    uint8_t *page_state;                /* State of each page. */
+    struct list free_lists[ORDER_CNT];  /* Free blocks by order. */
+    size_t page_cnt;                    /* Number of pages. */
+    size_t free_cnt;                    /* Number of free pages. */
+    size_t lent_cnt;                    /* Number of PAGE_LENT pages. */
     uint8_t *base;                      /* Base of pool. */
   };
 
-/* Two pools: one for kernel data, one for user pages. */
-static struct pool kernel_pool, user_pool;
+/* Three pools: one for kernel data, one for user pages, and one
+   that either may borrow from. */
+static struct pool kernel_pool, user_pool, shared_pool;
+
+/* Shared pool watermarks, in free pages. */
+static size_t low_water, high_water;
+
+/* Most pages the shared pool may lend to user allocations, to
+   honor the user page limit given to palloc_init(). */
+static size_t lend_limit;
+
+/* Reclaiming lent pages. */
+static palloc_reclaim_func *reclaim_func;
+static struct work reclaim_work;
+static unsigned reclaim_runs;           /* Times reclaim_work ran. */
+static unsigned reclaimed_cnt;          /* Pages reclaimed. */
+static unsigned refused_cnt;            /* User requests not lent. */
+
+/* -poolstat: Sample pool occupancy every POOLSTAT_INTERVAL ticks,
+   keeping the latest POOLSTAT_SAMPLES samples. */
+#define POOLSTAT_INTERVAL TIMER_FREQ
+#define POOLSTAT_SAMPLES 64
+bool poolstat_enabled;
+
+/* A sample of pool occupancy, in allocated pages. */
+struct pool_sample
+  {
+    int64_t ticks;                      /* When taken. */
+    size_t kernel_used;                 /* In the kernel pool. */
+    size_t user_used;                   /* In the user pool. */
+    size_t shared_kernel;               /* Kernel pages in shared pool. */
+    size_t shared_user;                 /* User pages in shared pool. */
+  };
+
+static struct pool_sample samples[POOLSTAT_SAMPLES];
+static unsigned sample_cnt;             /* Samples taken. */
+static struct delayed_work sample_work;
 
 static void init_pool (struct pool *, void *base, size_t page_cnt,
                        const char *name);
+static void *get_pages (struct pool *, size_t page_cnt, bool lend);
 static bool page_from_pool (const struct pool *, void *page);
+static size_t largest_free (struct pool *);
+static void reclaim (struct work *);
+static void sample (struct work *);
+static size_t alloc_block (struct pool *, int order);
+static void free_range (struct pool *, size_t page_idx, size_t page_cnt);
+static void free_block (struct pool *, size_t page_idx, int order);
+static struct list_elem *block_elem (const struct pool *, size_t page_idx);
+static size_t block_idx (const struct pool *, struct list_elem *);
+static int order_for (size_t page_cnt);
 
 /* Initializes the page allocator.  At most USER_PAGE_LIMIT
-   pages are put into the user pool. */
+   pages are put into the user pool or lent to user pages by the
+   shared pool. */
 void
 palloc_init (size_t user_page_limit)
 {
@@ -49,42 +141,55 @@ palloc_init (size_t user_page_limit)
   uint8_t *free_start = ptov (1024 * 1024);
   uint8_t *free_end = ptov (init_ram_pages * PGSIZE);
   size_t free_pages = (free_end - free_start) / PGSIZE;
-  size_t user_pages = free_pages / 2;
-  size_t kernel_pages;
+  size_t kernel_pages = free_pages / 4;
+  size_t user_pages = free_pages / 4;
+  size_t shared_pages;
   if (user_pages > user_page_limit)
     user_pages = user_page_limit;
-  kernel_pages = free_pages - user_pages;
+  shared_pages = free_pages - kernel_pages - user_pages;
 
-  /* Give half of memory to kernel, half to user. */
+  /* Give a quarter of memory to kernel, a quarter to user, and
+     the rest to the shared pool. */
   init_pool (&kernel_pool, free_start, kernel_pages, "kernel pool");
-  init_pool (&user_pool, free_start + kernel_pages * PGSIZE,
+  init_pool (&shared_pool, free_start + kernel_pages * PGSIZE,
+             shared_pages, "shared pool");
+  init_pool (&user_pool, free_start + (kernel_pages + shared_pages) * PGSIZE,
              user_pages, "user pool");
+
+  low_water = shared_pool.page_cnt / 16;
+  high_water = shared_pool.page_cnt / 8;
+  lend_limit = user_page_limit - user_pages;
+  work_init (&reclaim_work, reclaim);
 }
 
 /* Obtains and returns a group of PAGE_CNT contiguous free pages.
    If PAL_USER is set, the pages are obtained from the user pool,
-   otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
+   otherwise from the kernel pool, or in either case from the
+   shared pool if they do not fit.  If PAL_ZERO is set in FLAGS,
    then the pages are filled with zeros.  If too few pages are
    available, returns a null pointer, unless PAL_ASSERT is set in
    FLAGS, in which case the kernel panics. */
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
 {
-  struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+  bool user = (flags & PAL_USER) != 0;
   void *pages;
-  size_t page_idx;
 
   if (page_cnt == 0)
     return NULL;
 
-  lock_acquire (&pool->lock);
-  page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-  lock_release (&pool->lock);
+  pages = get_pages (user ? &user_pool : &kernel_pool, page_cnt, false);
+  if (pages == NULL)
+    {
+      pages = get_pages (&shared_pool, page_cnt, user);
 
-  if (page_idx != BITMAP_ERROR)
-    pages = pool->base + PGSIZE * page_idx;
-  else
-    pages = NULL;
+      /* Take back lent pages if the kernel is running short.  The
+         counts are read with interrupts on, which is good enough
+         for deciding whether to start. */
+      if (pages != NULL && !user && reclaim_func != NULL
+          && shared_pool.free_cnt < low_water && shared_pool.lent_cnt > 0)
+        queue_work (system_wq, &reclaim_work);
+    }
 
   if (pages != NULL) 
     {
@@ -103,8 +208,9 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
 /* Obtains a single free page and returns its kernel virtual
    address.
    If PAL_USER is set, the page is obtained from the user pool,
-   otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
-   then the page is filled with zeros.  If no pages are
+   otherwise from the kernel pool, or in either case from the
+   shared pool if the page does not fit.  If PAL_ZERO is set in
+   FLAGS, then the page is filled with zeros.  If no pages are
    available, returns a null pointer, unless PAL_ASSERT is set in
    FLAGS, in which case the kernel panics. */
 void *
@@ -119,6 +225,7 @@ palloc_free_multiple (void *pages, size_t page_cnt)
 {
   struct pool *pool;
   size_t page_idx;
+  enum intr_level old_level;
 
   ASSERT (pg_ofs (pages) == 0);
   if (pages == NULL || page_cnt == 0)
@@ -128,17 +235,21 @@ palloc_free_multiple (void *pages, size_t page_cnt)
     pool = &kernel_pool;
   else if (page_from_pool (&user_pool, pages))
     pool = &user_pool;
+  else if (page_from_pool (&shared_pool, pages))
+    pool = &shared_pool;
   else
     NOT_REACHED ();
 
   page_idx = pg_no (pages) - pg_no (pool->base);
+  ASSERT (page_idx + page_cnt <= pool->page_cnt);
 
 #ifndef NDEBUG
   memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
 
-  ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
-  bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  old_level = intr_disable ();
+  free_range (pool, page_idx, page_cnt);
+  intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -148,25 +259,217 @@ palloc_free_page (void *page)
   palloc_free_multiple (page, 1);
 }
 
+/* Returns true if PAGE is a user page that the shared pool lent
+   out, that is, one that reclaiming would give back to the
+   kernel. */
+bool
+palloc_lent (void *page)
+{
+  return (page_from_pool (&shared_pool, page)
+          && shared_pool.page_state[pg_no (page) - pg_no (shared_pool.base)]
+             == PAGE_LENT);
+}
+
+/* Registers FUNC to reclaim user pages lent out by the shared
+   pool.  FUNC is called from a kernel worker thread, for as long
+   as the shared pool is short of free pages and FUNC keeps
+   returning true. */
+void
+palloc_set_reclaim (palloc_reclaim_func *func)
+{
+  reclaim_func = func;
+}
+
+/* Returns the number of free pages that allocations with FLAGS
+   could get, from their own pool and the shared pool. */
+size_t
+palloc_free_cnt (enum palloc_flags flags)
+{
+  size_t free_cnt = shared_pool.free_cnt;
+
+  if (flags & PAL_USER)
+    {
+      size_t lendable = lend_limit - shared_pool.lent_cnt;
+
+      free_cnt = free_cnt > low_water ? free_cnt - low_water : 0;
+      if (free_cnt > lendable)
+        free_cnt = lendable;
+      return user_pool.free_cnt + free_cnt;
+    }
+  return kernel_pool.free_cnt + free_cnt;
+}
+
+/* Returns the number of pages in the largest group that
+   palloc_get_multiple() could allocate right now with FLAGS. */
+size_t
+palloc_largest_free (enum palloc_flags flags)
+{
+  bool user = (flags & PAL_USER) != 0;
+  size_t largest = largest_free (user ? &user_pool : &kernel_pool);
+  size_t shared = largest_free (&shared_pool);
+
+  if (user)
+    {
+      size_t lendable = lend_limit - shared_pool.lent_cnt;
+
+      /* Smaller requests split the same block. */
+      while (shared > 0 && shared_pool.free_cnt < shared + low_water)
+        shared /= 2;
+      if (shared > lendable)
+        shared = lendable;
+    }
+  return largest > shared ? largest : shared;
+}
+
+/* Starts sampling pool occupancy, for palloc_print_stats().
+   Must be called after the timer and workqueues are
+   initialized. */
+void
+palloc_stat_start (void)
+{
+  delayed_work_init (&sample_work, sample);
+  queue_work (system_wq, &sample_work.work);
+}
+
+/* Prints page pool statistics, including the occupancy samples
+   if -poolstat was given. */
+void
+palloc_print_stats (void)
+{
+  unsigned first = sample_cnt > POOLSTAT_SAMPLES
+                   ? sample_cnt - POOLSTAT_SAMPLES : 0;
+  unsigned i;
+
+  printf ("Pools: kernel %zu, user %zu, shared %zu pages "
+          "(low %zu, high %zu)\n", kernel_pool.page_cnt, user_pool.page_cnt,
+          shared_pool.page_cnt, low_water, high_water);
+  printf ("Pools: %u reclaim runs took back %u pages, "
+          "%u user requests not lent\n",
+          reclaim_runs, reclaimed_cnt, refused_cnt);
+  if (sample_cnt == 0)
+    return;
+
+  printf ("Pools: %8s %8s %8s %8s %8s\n",
+          "ticks", "kernel", "user", "sh-kern", "sh-user");
+  for (i = first; i < sample_cnt; i++)
+    {
+      const struct pool_sample *s = &samples[i % POOLSTAT_SAMPLES];
+      printf ("Pools: %8"PRId64" %8zu %8zu %8zu %8zu\n", s->ticks,
+              s->kernel_used, s->user_used, s->shared_kernel,
+              s->shared_user);
+    }
+}
+
+/* Allocates PAGE_CNT contiguous pages from POOL, marking them as
+   lent to a user page if LEND is true, in which case POOL must
+   be the shared pool.  Returns the pages, or a null pointer if
+   POOL cannot supply them. */
+static void *
+get_pages (struct pool *pool, size_t page_cnt, bool lend)
+{
+  size_t page_idx = SIZE_MAX;
+  int order = order_for (page_cnt);
+  enum intr_level old_level;
+
+  ASSERT (!lend || pool == &shared_pool);
+
+  old_level = intr_disable ();
+  if (lend && (pool->free_cnt < page_cnt + low_water
+               || pool->lent_cnt + page_cnt > lend_limit))
+    refused_cnt++;
+  else if (order < ORDER_CNT)
+    page_idx = alloc_block (pool, order);
+  if (page_idx != SIZE_MAX)
+    {
+      if (page_cnt < (size_t) 1 << order)
+        free_range (pool, page_idx + page_cnt,
+                    ((size_t) 1 << order) - page_cnt);
+      if (lend)
+        {
+          memset (pool->page_state + page_idx, PAGE_LENT, page_cnt);
+          pool->lent_cnt += page_cnt;
+        }
+    }
+  intr_set_level (old_level);
+
+  return page_idx != SIZE_MAX ? pool->base + PGSIZE * page_idx : NULL;
+}
+
+/* Returns the number of pages in the largest free block in
+   POOL. */
+static size_t
+largest_free (struct pool *pool)
+{
+  size_t largest = 0;
+  int order;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  for (order = ORDER_CNT - 1; order >= 0; order--)
+    if (!list_empty (&pool->free_lists[order]))
+      {
+        largest = (size_t) 1 << order;
+        break;
+      }
+  intr_set_level (old_level);
+  return largest;
+}
+
+/* Work function that reclaims lent pages until the shared pool
+   is back above its high watermark. */
+static void
+reclaim (struct work *work UNUSED)
+{
+  reclaim_runs++;
+  while (shared_pool.free_cnt < high_water && shared_pool.lent_cnt > 0
+         && reclaim_func ())
+    reclaimed_cnt++;
+}
+
+/* Work function that records a sample of pool occupancy and
+   requeues itself. */
+static void
+sample (struct work *work UNUSED)
+{
+  struct pool_sample *s = &samples[sample_cnt++ % POOLSTAT_SAMPLES];
+  size_t shared_used = shared_pool.page_cnt - shared_pool.free_cnt;
+  size_t lent = shared_pool.lent_cnt;
+
+  s->ticks = timer_ticks ();
+  s->kernel_used = kernel_pool.page_cnt - kernel_pool.free_cnt;
+  s->user_used = user_pool.page_cnt - user_pool.free_cnt;
+  s->shared_user = lent < shared_used ? lent : shared_used;
+  s->shared_kernel = shared_used - s->shared_user;
+  queue_delayed_work (system_wq, &sample_work, POOLSTAT_INTERVAL);
+}
+
 /* Initializes pool P as starting at START and ending at END,
    naming it NAME for debugging purposes. */
 static void
 init_pool (struct pool *p, void *base, size_t page_cnt, const char *name) 
 {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
-     and subtract it from the pool's size. */
-  size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (page_cnt), PGSIZE);
-  if (bm_pages > page_cnt)
-    PANIC ("Not enough memory in %s for bitmap.", name);
-  page_cnt -= bm_pages;
+  /* We'll put the pool's page_state array at its base.
+     Calculate the space needed for it and subtract it from the
+     pool's size. */
+  size_t state_pages = DIV_ROUND_UP (page_cnt, PGSIZE + 1);
+  int order;
+
+  if (state_pages > page_cnt)
+    PANIC ("Not enough memory in %s for page states.", name);
+  page_cnt -= state_pages;
 
   printf ("%zu pages available in %s.\n", page_cnt, name);
 
-  /* Initialize the pool. */
-  lock_init (&p->lock);
-  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_pages * PGSIZE);
-  p->base = base + bm_pages * PGSIZE;
+  /* Initialize the pool, with every page free. */
+  p->page_state = base;
+  memset (p->page_state, PAGE_USED, page_cnt);
+  for (order = 0; order < ORDER_CNT; order++)
+    list_init (&p->free_lists[order]);
+  p->page_cnt = page_cnt;
+  p->free_cnt = 0;
+  p->lent_cnt = 0;
+  p->base = (uint8_t *) base + state_pages * PGSIZE;
+  free_range (p, 0, page_cnt);
 }
 
 /* Returns true if PAGE was allocated from POOL,
@@ -176,7 +479,128 @@ page_from_pool (const struct pool *pool, void *page)
 {
   size_t page_no = pg_no (page);
   size_t start_page = pg_no (pool->base);
-  size_t end_page = start_page + bitmap_size (pool->used_map);
+  size_t end_page = start_page + pool->page_cnt;
 
   return page_no >= start_page && page_no < end_page;
 }
+
+/* Allocates a block of 2**ORDER pages from POOL, splitting a
+   larger block if there is no free block of that order.  Returns
+   the block's first page index, or SIZE_MAX if there is no block
+   large enough.  Interrupts must be off. */
+static size_t
+alloc_block (struct pool *pool, int order)
+{
+  size_t page_idx;
+  int o;
+
+  for (o = order; o < ORDER_CNT; o++)
+    if (!list_empty (&pool->free_lists[o]))
+      break;
+  if (o == ORDER_CNT)
+    return SIZE_MAX;
+
+  page_idx = block_idx (pool, list_pop_front (&pool->free_lists[o]));
+  ASSERT (pool->page_state[page_idx] == o);
+
+  /* Split off and free the upper halves down to ORDER. */
+  while (o > order)
+    {
+      size_t buddy;
+
+      o--;
+      buddy = page_idx + ((size_t) 1 << o);
+      pool->page_state[buddy] = o;
+      list_push_front (&pool->free_lists[o], block_elem (pool, buddy));
+    }
+
+  memset (pool->page_state + page_idx, PAGE_USED, (size_t) 1 << order);
+  pool->free_cnt -= (size_t) 1 << order;
+  return page_idx;
+}
+
+/* Frees the PAGE_CNT allocated pages starting at PAGE_IDX in
+   POOL, as the largest aligned blocks that cover them.
+   Interrupts must be off, except during initialization. */
+static void
+free_range (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  while (page_cnt > 0)
+    {
+      int order = 0;
+
+      while (order + 1 < ORDER_CNT
+             && page_idx % ((size_t) 2 << order) == 0
+             && ((size_t) 2 << order) <= page_cnt)
+        order++;
+      free_block (pool, page_idx, order);
+      page_idx += (size_t) 1 << order;
+      page_cnt -= (size_t) 1 << order;
+    }
+}
+
+/* Frees the allocated block of 2**ORDER pages at PAGE_IDX in
+   POOL, merging it with its buddy for as long as the buddy is
+   free.  Interrupts must be off, except during
+   initialization. */
+static void
+free_block (struct pool *pool, size_t page_idx, int order)
+{
+  size_t page_cnt = (size_t) 1 << order;
+  size_t i;
+
+  for (i = 0; i < page_cnt; i++)
+    {
+      uint8_t *state = &pool->page_state[page_idx + i];
+
+      ASSERT (*state == PAGE_USED || *state == PAGE_LENT);
+      if (*state == PAGE_LENT)
+        pool->lent_cnt--;
+      *state = PAGE_FREE;
+    }
+  pool->free_cnt += page_cnt;
+
+  while (order + 1 < ORDER_CNT)
+    {
+      size_t buddy = page_idx ^ ((size_t) 1 << order);
+
+      if (buddy >= pool->page_cnt || pool->page_state[buddy] != order)
+        break;
+      list_remove (block_elem (pool, buddy));
+      pool->page_state[buddy] = PAGE_FREE;
+      if (buddy < page_idx)
+        page_idx = buddy;
+      order++;
+    }
+
+  pool->page_state[page_idx] = order;
+  list_push_front (&pool->free_lists[order], block_elem (pool, page_idx));
+}
+
+/* Returns the free list element of the free block at PAGE_IDX
+   in POOL, which is kept in the block's first page. */
+static struct list_elem *
+block_elem (const struct pool *pool, size_t page_idx)
+{
+  return (struct list_elem *) (pool->base + PGSIZE * page_idx);
+}
+
+/* Returns the page index in POOL of the free block whose free
+   list element is E. */
+static size_t
+block_idx (const struct pool *pool, struct list_elem *e)
+{
+  return ((uint8_t *) e - pool->base) / PGSIZE;
+}
+
+/* Returns the smallest order of a block of at least PAGE_CNT
+   pages. */
+static int
+order_for (size_t page_cnt)
+{
+  int order = 0;
+
+  while (order < ORDER_CNT && ((size_t) 1 << order) < page_cnt)
+    order++;
+  return order;
+}
@@ -1,6 +1,7 @@
 #ifndef THREADS_PALLOC_H
 #define THREADS_PALLOC_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /* How to allocate pages. */
@@ -11,10 +12,23 @@ enum palloc_flags
     PAL_USER = 004              /* User page. */
   };
 
+/* Reclaims one user page lent out by the shared pool, returning
+   false if there is none that can be reclaimed. */
+typedef bool palloc_reclaim_func (void);
+
+/* -poolstat: Sample pool occupancy? */
+extern bool poolstat_enabled;
+
 void palloc_init (size_t user_page_limit);
 void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+size_t palloc_free_cnt (enum palloc_flags);
+size_t palloc_largest_free (enum palloc_flags);
+bool palloc_lent (void *);
+void palloc_set_reclaim (palloc_reclaim_func *);
+void palloc_stat_start (void);
+void palloc_print_stats (void);
 
 #endif /* threads/palloc.h */
@@ -0,0 +1,127 @@
+#include "threads/profile.h"
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Histogram of samples.  Identical samples share a slot, found
+   by hashing and linear probing; PROFILE_SLOTS must be a power
+   of 2. */
+#define PROFILE_SLOTS 1024
+#define PROFILE_PROBES 16       /* Slots to try before dropping. */
+
+/* A histogram slot. */
+struct profile_slot
+  {
+    uintptr_t eip;              /* Interrupted instruction. */
+    tid_t tid;                  /* Interrupted thread. */
+    bool user;                  /* In user mode? */
+    unsigned count;             /* Number of samples, 0 if unused. */
+  };
+
+static struct profile_slot histogram[PROFILE_SLOTS];
+
+/* Sampling state.  Modified only with interrupts off. */
+static unsigned interval;       /* Ticks between samples, 0 if off. */
+static unsigned countdown;      /* Ticks until next sample. */
+static unsigned sample_cnt;     /* Samples taken. */
+static unsigned dropped_cnt;    /* Samples that did not fit. */
+
+static void record (uintptr_t eip, tid_t tid, bool user);
+
+/* Clears the histogram and starts sampling every INTERVAL timer
+   ticks. */
+void
+profile_start (unsigned interval_)
+{
+  enum intr_level old_level;
+
+  ASSERT (interval_ > 0);
+
+  old_level = intr_disable ();
+  memset (histogram, 0, sizeof histogram);
+  sample_cnt = dropped_cnt = 0;
+  interval = countdown = interval_;
+  intr_set_level (old_level);
+}
+
+/* Stops sampling.  The histogram is kept for profile_print(). */
+void
+profile_stop (void)
+{
+  interval = 0;
+}
+
+/* Returns true if the profiler is sampling. */
+bool
+profile_running (void)
+{
+  return interval != 0;
+}
+
+/* Called by the timer interrupt handler with the interrupted
+   context F. */
+void
+profile_interrupt (const struct intr_frame *f)
+{
+  ASSERT (intr_context ());
+
+  if (interval == 0 || --countdown > 0)
+    return;
+  countdown = interval;
+
+  /* The low bits of the code segment selector are the privilege
+     level of the interrupted code: 3 for user mode. */
+  record ((uintptr_t) f->eip, thread_current ()->tid, (f->cs & 3) == 3);
+}
+
+/* Prints the histogram to the console.  Sampling pauses while
+   the histogram is printed. */
+void
+profile_print (void)
+{
+  unsigned saved_interval = interval;
+  size_t i;
+
+  interval = 0;
+  printf ("Profile: %u samples every %u ticks, %u dropped\n",
+          sample_cnt, saved_interval, dropped_cnt);
+  for (i = 0; i < PROFILE_SLOTS; i++)
+    {
+      const struct profile_slot *s = &histogram[i];
+      if (s->count != 0)
+        printf ("Profile: %u %s %d 0x%08x\n", s->count,
+                s->user ? "user" : "kernel", s->tid, (unsigned) s->eip);
+    }
+  interval = saved_interval;
+}
+
+/* Counts a sample at EIP in thread TID, in user mode if USER is
+   true. */
+static void
+record (uintptr_t eip, tid_t tid, bool user)
+{
+  unsigned hash = (eip ^ ((unsigned) tid << 1) ^ user) * 2654435761u;
+  int probe;
+
+  hash ^= hash >> 16;
+
+  sample_cnt++;
+  for (probe = 0; probe < PROFILE_PROBES; probe++)
+    {
+      struct profile_slot *s = &histogram[(hash + probe) % PROFILE_SLOTS];
+      if (s->count == 0)
+        {
+          s->eip = eip;
+          s->tid = tid;
+          s->user = user;
+        }
+      else if (s->eip != eip || s->tid != tid || s->user != user)
+        continue;
+      s->count++;
+      return;
+    }
+  dropped_cnt++;
+}
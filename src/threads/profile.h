@@ -0,0 +1,31 @@
+#ifndef THREADS_PROFILE_H
+#define THREADS_PROFILE_H
+
+#include <stdbool.h>
+
+/* Statistical profiler.
+
+   While the profiler runs, every Nth timer interrupt records
+   the address of the instruction that was interrupted, whether
+   it was in the kernel or in a user program, and which thread
+   was running.  Each distinct sample is counted in a fixed-size
+   histogram, so sampling takes no memory allocation and bounded
+   time; samples that do not fit are counted as dropped.
+
+   profile_print() writes the histogram to the console as lines
+   of the form
+
+        Profile: COUNT kernel|user TID ADDRESS
+
+   which "backtrace --profile" turns into a flat profile by
+   function. */
+
+struct intr_frame;
+
+void profile_start (unsigned interval);
+void profile_stop (void);
+bool profile_running (void);
+void profile_interrupt (const struct intr_frame *);
+void profile_print (void);
+
+#endif /* threads/profile.h */
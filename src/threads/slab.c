@@ -0,0 +1,337 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Objects a magazine holds, and how many move between a
+   magazine and the slabs at a time. */
+#define MAGAZINE_SIZE 16
+#define MAGAZINE_BATCH (MAGAZINE_SIZE / 2)
+
+/* A cache of free objects in front of the slabs. */
+struct magazine
+  {
+    size_t cnt;                         /* Number of objects. */
+    void *objs[MAGAZINE_SIZE];          /* Free objects, last in first out. */
+  };
+
+/* An object cache. */
+struct kmem_cache
+  {
+    const char *name;                   /* Name for statistics. */
+    size_t obj_size;                    /* Object size from creator. */
+    size_t slot_size;                   /* Bytes per object in a slab. */
+    size_t link_ofs;                    /* Offset of free list link. */
+    size_t objs_per_slab;               /* Objects in each slab. */
+    kmem_ctor_func *ctor;               /* Constructor, if any. */
+
+    struct lock lock;                   /* Protects the members below. */
+    struct lock_class lock_class;       /* Statistics for `lock'. */
+    struct list partial;                /* Slabs with free objects. */
+    struct list full;                   /* Slabs without free objects. */
+    struct slab *empty;                 /* A spare slab, all free, or null. */
+    size_t slab_cnt;                    /* Slabs, including the spare. */
+    size_t free_cnt;                    /* Free objects in slabs. */
+
+    struct magazine mag;                /* Recently freed objects. */
+    struct list_elem elem;              /* Element in `caches'. */
+  };
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* A slab: a page of objects, with this header at its start. */
+struct slab
+  {
+    unsigned magic;                     /* Always SLAB_MAGIC. */
+    struct kmem_cache *cache;           /* Owning cache. */
+    struct list_elem elem;              /* In cache's partial or full. */
+    void *free;                         /* First free object. */
+    size_t free_cnt;                    /* Number of free objects. */
+  };
+
+/* Offset of the first object in a slab. */
+#define SLAB_HEADER_SIZE ROUND_UP (sizeof (struct slab), 8)
+
+/* All object caches. */
+static struct list caches = LIST_INITIALIZER (caches);
+
+static void *slab_alloc (struct kmem_cache *);
+static void slab_free (struct kmem_cache *, void *);
+static struct slab *slab_create (struct kmem_cache *);
+static void **obj_link (struct kmem_cache *, void *);
+
+/* Creates and returns a cache for objects of SIZE bytes named
+   NAME, which must stay valid as long as the cache.  If CTOR is
+   nonnull, it constructs each object.  Panics if memory is not
+   available, since caches are created during initialization. */
+struct kmem_cache *
+kmem_cache_create (const char *name, size_t size, kmem_ctor_func *ctor)
+{
+  struct kmem_cache *c;
+
+  ASSERT (size > 0);
+
+  c = calloc (1, sizeof *c);
+  if (c == NULL)
+    PANIC ("kmem_cache_create: out of memory for cache %s", name);
+
+  /* Free objects keep the free list link in their first word,
+     unless that would undo the constructor's work, in which case
+     the link goes after the object. */
+  c->name = name;
+  c->obj_size = size;
+  c->slot_size = ROUND_UP (size, sizeof (void *));
+  c->link_ofs = 0;
+  if (ctor != NULL)
+    {
+      c->link_ofs = c->slot_size;
+      c->slot_size += sizeof (void *);
+    }
+  c->objs_per_slab = (PGSIZE - SLAB_HEADER_SIZE) / c->slot_size;
+  c->ctor = ctor;
+  ASSERT (c->objs_per_slab > 0);
+
+  lock_class_init (&c->lock_class, name);
+  lock_init_class (&c->lock, &c->lock_class);
+  list_init (&c->partial);
+  list_init (&c->full);
+  list_push_back (&caches, &c->elem);
+  return c;
+}
+
+/* Allocates and returns an object from cache C.  Returns a null
+   pointer if memory is not available. */
+void *
+kmem_cache_alloc (struct kmem_cache *c)
+{
+  void *batch[MAGAZINE_BATCH];
+  size_t cnt = 0;
+  struct magazine *m;
+  enum intr_level old_level;
+  void *obj = NULL;
+
+  ASSERT (!intr_context ());
+
+  /* Fast path: take an object from the magazine. */
+  old_level = intr_disable ();
+  m = &c->mag;
+  if (m->cnt > 0)
+    obj = m->objs[--m->cnt];
+  intr_set_level (old_level);
+  if (obj != NULL)
+    return obj;
+
+  /* The magazine is empty.  Take a batch from the slabs. */
+  lock_acquire (&c->lock);
+  while (cnt < MAGAZINE_BATCH && (obj = slab_alloc (c)) != NULL)
+    batch[cnt++] = obj;
+  lock_release (&c->lock);
+  if (cnt == 0)
+    return NULL;
+  obj = batch[--cnt];
+
+  /* Keep the rest in the magazine, unless another thread has
+     refilled it in the meantime. */
+  old_level = intr_disable ();
+  m = &c->mag;
+  while (cnt > 0 && m->cnt < MAGAZINE_SIZE)
+    m->objs[m->cnt++] = batch[--cnt];
+  intr_set_level (old_level);
+
+  if (cnt > 0)
+    {
+      lock_acquire (&c->lock);
+      while (cnt > 0)
+        slab_free (c, batch[--cnt]);
+      lock_release (&c->lock);
+    }
+  return obj;
+}
+
+/* Returns OBJ, which must have been allocated from cache C, to
+   C.  Does nothing if OBJ is a null pointer. */
+void
+kmem_cache_free (struct kmem_cache *c, void *obj)
+{
+  void *batch[MAGAZINE_BATCH];
+  size_t cnt = 0;
+  struct magazine *m;
+  enum intr_level old_level;
+
+  ASSERT (!intr_context ());
+
+  if (obj == NULL)
+    return;
+
+#ifndef NDEBUG
+  /* Clear the object to help detect use-after-free bugs. */
+  if (c->ctor == NULL)
+    memset (obj, 0xcc, c->obj_size);
+#endif
+
+  /* Fast path: put the object in the magazine.  If it is full,
+     take out a batch to give back to the slabs. */
+  old_level = intr_disable ();
+  m = &c->mag;
+  if (m->cnt < MAGAZINE_SIZE)
+    m->objs[m->cnt++] = obj;
+  else
+    {
+      batch[cnt++] = obj;
+      while (cnt < MAGAZINE_BATCH)
+        batch[cnt++] = m->objs[--m->cnt];
+    }
+  intr_set_level (old_level);
+
+  if (cnt > 0)
+    {
+      lock_acquire (&c->lock);
+      while (cnt > 0)
+        slab_free (c, batch[--cnt]);
+      lock_release (&c->lock);
+    }
+}
+
+/* Prints statistics for each object cache. */
+void
+kmem_print_stats (void)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&caches); e != list_end (&caches); e = list_next (e))
+    {
+      struct kmem_cache *c = list_entry (e, struct kmem_cache, elem);
+      size_t cached = c->mag.cnt;
+
+      printf ("Slab: %s: %zu-byte objects, %zu slabs, %zu in use, "
+              "%zu free, %zu in magazines\n",
+              c->name, c->slot_size, c->slab_cnt,
+              c->slab_cnt * c->objs_per_slab - c->free_cnt - cached,
+              c->free_cnt, cached);
+    }
+}
+
+/* Takes a free object out of C's slabs, creating a slab if
+   necessary, and returns it, or a null pointer if memory is not
+   available.  C's lock must be held. */
+static void *
+slab_alloc (struct kmem_cache *c)
+{
+  struct slab *s;
+  void *obj;
+
+  ASSERT (lock_held_by_current_thread (&c->lock));
+
+  if (list_empty (&c->partial))
+    {
+      s = c->empty;
+      if (s != NULL)
+        c->empty = NULL;
+      else
+        {
+          s = slab_create (c);
+          if (s == NULL)
+            return NULL;
+        }
+      list_push_front (&c->partial, &s->elem);
+    }
+
+  s = list_entry (list_front (&c->partial), struct slab, elem);
+  obj = s->free;
+  s->free = *obj_link (c, obj);
+  c->free_cnt--;
+  if (--s->free_cnt == 0)
+    {
+      list_remove (&s->elem);
+      list_push_back (&c->full, &s->elem);
+    }
+  return obj;
+}
+
+/* Returns OBJ to its slab in C.  A slab that becomes entirely
+   free is kept as C's spare if C has none, or else given back
+   to the page allocator.  C's lock must be held. */
+static void
+slab_free (struct kmem_cache *c, void *obj)
+{
+  struct slab *s = pg_round_down (obj);
+
+  ASSERT (lock_held_by_current_thread (&c->lock));
+  ASSERT (s->magic == SLAB_MAGIC);
+  ASSERT (s->cache == c);
+  ASSERT ((pg_ofs (obj) - SLAB_HEADER_SIZE) % c->slot_size == 0);
+
+  *obj_link (c, obj) = s->free;
+  s->free = obj;
+  c->free_cnt++;
+  if (s->free_cnt++ == 0)
+    {
+      /* Was full. */
+      list_remove (&s->elem);
+      list_push_front (&c->partial, &s->elem);
+    }
+  if (s->free_cnt == c->objs_per_slab)
+    {
+      list_remove (&s->elem);
+      if (c->empty == NULL)
+        c->empty = s;
+      else
+        {
+          c->free_cnt -= s->free_cnt;
+          c->slab_cnt--;
+          palloc_free_page (s);
+        }
+    }
+}
+
+/* Creates a new slab for C, with all its objects free and
+   constructed.  Returns the new slab, or a null pointer if
+   memory is not available. */
+static struct slab *
+slab_create (struct kmem_cache *c)
+{
+  struct slab *s = palloc_get_page (0);
+  uint8_t *obj;
+  size_t i;
+
+  if (s == NULL)
+    return NULL;
+
+  s->magic = SLAB_MAGIC;
+  s->cache = c;
+  s->free = NULL;
+  s->free_cnt = c->objs_per_slab;
+
+  /* Link the objects in address order. */
+  obj = (uint8_t *) s + SLAB_HEADER_SIZE + c->objs_per_slab * c->slot_size;
+  for (i = 0; i < c->objs_per_slab; i++)
+    {
+      obj -= c->slot_size;
+      if (c->ctor != NULL)
+        c->ctor (obj);
+      *obj_link (c, obj) = s->free;
+      s->free = obj;
+    }
+
+  c->slab_cnt++;
+  c->free_cnt += c->objs_per_slab;
+  return s;
+}
+
+/* Returns the location of the free list link in OBJ, a free
+   object in C. */
+static void **
+obj_link (struct kmem_cache *c, void *obj)
+{
+  return (void **) ((uint8_t *) obj + c->link_ofs);
+}
@@ -0,0 +1,33 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <stddef.h>
+
+/* Slab allocator.
+
+   An object cache hands out objects of one fixed size, packed
+   into pages ("slabs") taken from the page allocator, so that an
+   object uses only as much memory as its size rounded up to a
+   word, instead of the next power of 2 as with malloc().
+
+   Each cache keeps a small magazine of free objects in front of
+   its slabs.  Allocating from and freeing to a magazine only
+   turns interrupts off; the cache's lock is taken only to
+   refill or drain a magazine in batches.
+
+   If a cache has a constructor, it is applied to each object
+   when its slab is created, and objects must be in their
+   constructed state again when they are freed. */
+
+struct kmem_cache;
+
+/* Constructor for the objects of a cache. */
+typedef void kmem_ctor_func (void *obj);
+
+struct kmem_cache *kmem_cache_create (const char *name, size_t size,
+                                      kmem_ctor_func *);
+void *kmem_cache_alloc (struct kmem_cache *);
+void kmem_cache_free (struct kmem_cache *, void *);
+void kmem_print_stats (void);
+
+#endif /* threads/slab.h */
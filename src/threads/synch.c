@@ -27,10 +27,24 @@
 */
 
 #include "threads/synch.h"
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/tsc.h"
+
+static heap_less_func waiter_priority_less;
+
+/* If true, locks collect statistics into their classes. */
+bool lockstat_enabled;
+
+/* List of all lock classes that have been used by lock_init(). */
+static struct list lock_classes = LIST_INITIALIZER (lock_classes);
+
+static void lock_stat_acquired (struct lock *, uint64_t start,
+                                bool contended);
+static void lock_stat_released (struct lock *);
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -47,7 +61,7 @@ sema_init (struct semaphore *sema, unsigned value)
   ASSERT (sema != NULL);
 
   sema->value = value;
-  list_init (&sema->waiters);
+  waitq_init (&sema->waiters);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -61,21 +75,38 @@ void
 sema_down (struct semaphore *sema) 
 {
   enum intr_level old_level;
+  struct thread *cur;
+  bool set_wait, set_entry;
 
   ASSERT (sema != NULL);
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
+
+  /* Unless our caller said what kind of wait this is, it is a
+     plain semaphore wait. */
+  cur = thread_current ();
+  set_wait = cur->wait == WAIT_OTHER;
+  if (set_wait)
+    cur->wait = WAIT_SEMA;
+
+  /* Likewise, donations re-key us in SEMA's waiters unless our
+     caller queued us somewhere that matters more. */
+  set_entry = cur->wait_entry == NULL;
+  if (set_entry)
+    cur->wait_entry = &cur->waitq_elem;
+
   while (sema->value == 0) 
     {
-      /* insert current thread to waiters list in descending order of priority */
-      list_insert_ordered(&sema->waiters, &thread_current()->elem, 
-          (list_less_func *) compare_priority_desc, NULL);
-
+      waitq_push (&sema->waiters, &cur->waitq_elem, cur->priority);
       thread_block ();
     }
 
   sema->value--;
+  if (set_wait)
+    cur->wait = WAIT_OTHER;
+  if (set_entry)
+    cur->wait_entry = NULL;
   intr_set_level (old_level);
 }
 
@@ -117,17 +148,13 @@ sema_up (struct semaphore *sema)
 
   old_level = intr_disable ();
 
-  if (!list_empty (&sema->waiters)) 
-  {
-    /* Reflect the change of priority in waiters */
-    list_sort(&sema->waiters, (list_less_func *) compare_priority_desc, NULL);
-    thread_unblock (list_entry (list_pop_front(&sema->waiters),
-                                struct thread, elem));
-  }
+  if (!waitq_empty (&sema->waiters)) 
+    thread_unblock (waitq_entry (waitq_pop (&sema->waiters),
+                                 struct thread, waitq_elem));
 
   sema->value++;
   
-  /* ready_list has been changed since we call thread_unblock(). 
+  /* The ready queues have been changed since we call thread_unblock(). 
      To reflect that, we call thread_preempt() preparing the case 
      which the first thread of waiters had higher priority than 
      current thread. */
@@ -190,14 +217,31 @@ sema_test_helper (void *sema_)
    another one "up" it, but with a lock the same thread must both
    acquire and release it.  When these restrictions prove
    onerous, it's a good sign that a semaphore should be used,
-   instead of a lock. */
+   instead of a lock.
+
+   LOCK's statistics go to CLASS.  The lock_init() macro supplies
+   a class for its call site, so most code should use that. */
 void
-lock_init (struct lock *lock)
+lock_init_class (struct lock *lock, struct lock_class *class)
 {
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
+  ASSERT (class != NULL);
 
   lock->holder = NULL;
   sema_init (&lock->semaphore, 1);
+  heap_init (&lock->waiters, waiter_priority_less, NULL);
+  lock->class = class;
+  lock->acquired_at = 0;
+
+  old_level = intr_disable ();
+  if (!class->registered) 
+    {
+      list_push_back (&lock_classes, &class->elem);
+      class->registered = true;
+    }
+  intr_set_level (old_level);
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -211,41 +255,64 @@ lock_init (struct lock *lock)
 void
 lock_acquire (struct lock *lock)
 {
+  uint64_t start = 0;
+  bool contended = false;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
+  if (lockstat_enabled) 
+    {
+      start = rdtsc ();
+      contended = lock->semaphore.value == 0;
+    }
+
   /* MLFQS does not support priority donation. It aims to make a fair and balanced system. 
    While priority inversion can occur, MLFQS does not directly address this issue. */
   if (thread_mlfqs) 
   {
+    thread_current ()->wait = WAIT_LOCK;
     sema_down (&lock->semaphore);
+    thread_current ()->wait = WAIT_OTHER;
     lock->holder = thread_current ();
+    lock_stat_acquired (lock, start, contended);
     
     return;
   }
 
   struct thread *cur = thread_current();
+  enum intr_level old_level;
 
-  /* if lock is already acquired, donate priority */
+  /* if lock is already acquired, queue up as one of its waiters
+     and donate priority along the chain of holders */
+  old_level = intr_disable ();
   if (lock->holder)
   {
-    struct thread *holder = lock->holder; 
     cur->lock_wait = lock;
+    heap_push (&lock->waiters, &cur->waiter_elem);
+    thread_donate_priority (cur);
+  }
+  intr_set_level (old_level);
 
-    /* Since a single thread can hold multiple locks, donation_list is a collection of 
-    threads that are waiting on the locks held by the current thread */
-    list_push_back(&holder->donation_list, &cur->donation_elem);
-
-    /*priority donation */
-    // thread_donate_priority(holder, 0);
-    thread_donate_priority_test();
-    
-  }    
-
+  cur->wait = WAIT_LOCK;
   sema_down (&lock->semaphore);
+  cur->wait = WAIT_OTHER;
+
+  old_level = intr_disable ();
+  if (cur->lock_wait != NULL)
+  {
+    heap_remove (&lock->waiters, &cur->waiter_elem);
+    cur->lock_wait = NULL;
+  }
   lock->holder = cur;
-  
+
+  /* Whoever is still waiting now donates to us. */
+  heap_push (&cur->held_locks, &lock->holder_elem);
+  thread_refresh_priority (cur);
+  intr_set_level (old_level);
+
+  lock_stat_acquired (lock, start, contended);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -264,7 +331,19 @@ lock_try_acquire (struct lock *lock)
 
   success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    {
+      struct thread *cur = thread_current ();
+      enum intr_level old_level = intr_disable ();
+
+      lock->holder = cur;
+      if (!thread_mlfqs)
+        {
+          heap_push (&cur->held_locks, &lock->holder_elem);
+          thread_refresh_priority (cur);
+        }
+      intr_set_level (old_level);
+      lock_stat_acquired (lock, 0, false);
+    }
   return success;
 }
 
@@ -279,19 +358,56 @@ lock_release (struct lock *lock)
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
-  lock->holder = NULL;
+  lock_stat_released (lock);
+
   struct thread *releasing_thread = thread_current();
+  enum intr_level old_level = intr_disable ();
 
-  /* Considering multiple donation case */
-  if (!thread_mlfqs && !list_empty(&releasing_thread->donation_list))
+  lock->holder = NULL;
+
+  /* Drop whatever the lock's waiters were donating to us. */
+  if (!thread_mlfqs)
   {
-    thread_remove_donation_elem(releasing_thread, lock);
-    thread_reflect_donation_list();
+    heap_remove (&releasing_thread->held_locks, &lock->holder_elem);
+    thread_refresh_priority (releasing_thread);
   }
+  intr_set_level (old_level);
 
   sema_up (&lock->semaphore);
 }
 
+/* Returns the priority of the highest-priority thread waiting
+   for LOCK, or PRI_MIN if there is none. */
+int
+lock_waiter_priority (const struct lock *lock) 
+{
+  ASSERT (lock != NULL);
+
+  if (heap_empty (&lock->waiters))
+    return PRI_MIN;
+  return heap_entry (heap_top (&lock->waiters),
+                     struct thread, waiter_elem)->priority;
+}
+
+/* Orders threads in a lock's waiters heap by priority. */
+static bool
+waiter_priority_less (const struct heap_elem *a, const struct heap_elem *b,
+                      void *aux UNUSED) 
+{
+  return (heap_entry (a, struct thread, waiter_elem)->priority
+          < heap_entry (b, struct thread, waiter_elem)->priority);
+}
+
+/* Orders locks in a thread's held_locks heap by the priority of
+   their highest-priority waiter. */
+bool
+lock_priority_less (const struct heap_elem *a, const struct heap_elem *b,
+                    void *aux UNUSED) 
+{
+  return (lock_waiter_priority (heap_entry (a, struct lock, holder_elem))
+          < lock_waiter_priority (heap_entry (b, struct lock, holder_elem)));
+}
+
 /* Returns true if the current thread holds LOCK, false
    otherwise.  (Note that testing whether some other thread holds
    a lock would be racy.) */
@@ -303,10 +419,11 @@ lock_held_by_current_thread (const struct lock *lock)
   return lock->holder == thread_current ();
 }
 
-/* One semaphore in a list. */
+
+/* One semaphore in a condition's wait queue. */
 struct semaphore_elem 
   {
-    struct list_elem elem;              /* List element. */
+    struct waitq_elem elem;             /* Wait queue element. */
     struct semaphore semaphore;         /* This semaphore. */
   };
 
@@ -318,7 +435,7 @@ cond_init (struct condition *cond)
 {
   ASSERT (cond != NULL);
 
-  list_init (&cond->waiters);
+  waitq_init (&cond->waiters);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -345,6 +462,7 @@ void
 cond_wait (struct condition *cond, struct lock *lock) 
 {
   struct semaphore_elem waiter;
+  struct thread *cur = thread_current ();
 
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
@@ -353,11 +471,16 @@ cond_wait (struct condition *cond, struct lock *lock)
   
   sema_init (&waiter.semaphore, 0);
 
-  list_insert_ordered(&cond->waiters, &waiter.elem, 
-      (list_less_func *)compare_cond_priority, NULL);
+  /* Only WAITER's semaphore is ours alone, so it is our place in
+     COND's waiters that a donation has to re-key. */
+  waitq_push (&cond->waiters, &waiter.elem, cur->priority);
+  cur->wait_entry = &waiter.elem;
 
   lock_release (lock);
+  cur->wait = WAIT_COND;
   sema_down (&waiter.semaphore);
+  cur->wait = WAIT_OTHER;
+  cur->wait_entry = NULL;
   lock_acquire (lock);
 }
 
@@ -376,12 +499,9 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED)
   ASSERT (!intr_context ());
   ASSERT (lock_held_by_current_thread (lock));
 
-  if (!list_empty (&cond->waiters))
-  {
-    /* Reflect the change of priority in waiters */
-    list_sort(&cond->waiters, (list_less_func *) &compare_cond_priority, NULL);
-    sema_up (&list_entry (list_pop_front(&cond->waiters), struct semaphore_elem, elem)->semaphore);
-  }
+  if (!waitq_empty (&cond->waiters))
+    sema_up (&waitq_entry (waitq_pop (&cond->waiters),
+                           struct semaphore_elem, elem)->semaphore);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -396,29 +516,237 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
 
-  while (!list_empty (&cond->waiters))
+  while (!waitq_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
 
+/* Initializes RW as an unheld reader-writer lock whose inner
+   lock reports to CLASS.  Most code should use the rwlock_init()
+   macro, which supplies a class for its call site. */
+void
+rwlock_init_class (struct rwlock *rw, struct lock_class *class) 
+{
+  ASSERT (rw != NULL);
+
+  lock_init_class (&rw->lock, class);
+  sema_init (&rw->drained, 0);
+  rw->readers = 0;
+  rw->writer_waiting = false;
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or
+   is waiting for it.
 
-int sema_get_max_priority(struct semaphore* sema)
+   A reader passes through RW's inner lock on the way in, so a
+   reader that has to wait donates its priority to the writer in
+   its way, just as with lock_acquire().  This function may
+   sleep, so it must not be called within an interrupt
+   handler. */
+void
+rwlock_acquire_read (struct rwlock *rw) 
 {
-  if(list_empty(&sema->waiters))
-    return -1;  
-  else
-    return list_entry(list_front(&sema->waiters), struct thread, elem)->priority;
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!rwlock_held_for_write (rw));
+
+  lock_acquire (&rw->lock);
+  old_level = intr_disable ();
+  rw->readers++;
+  intr_set_level (old_level);
+  lock_release (&rw->lock);
+}
+
+/* Releases RW, which the current thread must hold for reading.
+   The last reader to leave wakes up a writer waiting for the
+   readers to drain. */
+void
+rwlock_release_read (struct rwlock *rw) 
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+
+  old_level = intr_disable ();
+  ASSERT (rw->readers > 0);
+  if (--rw->readers == 0 && rw->writer_waiting)
+    sema_up (&rw->drained);
+  intr_set_level (old_level);
 }
 
+/* Acquires RW for writing, sleeping until no other writer holds
+   it and every reader has left.
+
+   The writer takes RW's inner lock first, which shuts out new
+   readers, and then waits for the readers already inside to
+   drain.  This function may sleep, so it must not be called
+   within an interrupt handler. */
+void
+rwlock_acquire_write (struct rwlock *rw) 
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rw->lock);
+  old_level = intr_disable ();
+  while (rw->readers > 0) 
+    {
+      rw->writer_waiting = true;
+      sema_down (&rw->drained);
+    }
+  rw->writer_waiting = false;
+  intr_set_level (old_level);
+}
+
+/* Releases RW, which the current thread must hold for
+   writing. */
+void
+rwlock_release_write (struct rwlock *rw) 
+{
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  lock_release (&rw->lock);
+}
+
+/* Returns true if the current thread holds RW for writing,
+   false otherwise. */
 bool
-compare_cond_priority(const struct list_elem *a, const struct list_elem *b, void *aux) {
+rwlock_held_for_write (const struct rwlock *rw) 
+{
+  ASSERT (rw != NULL);
+
+  return lock_held_by_current_thread (&rw->lock);
+}
+
+
+/* Initializes CLASS as a lock class named NAME with no
+   statistics, for locks that want a class of their own rather
+   than the one for their lock_init() call site. */
+void
+lock_class_init (struct lock_class *class, const char *name) 
+{
+  ASSERT (class != NULL);
+  ASSERT (name != NULL);
+
+  memset (class, 0, sizeof *class);
+  class->name = name;
+}
 
-  struct semaphore_elem *first_sema = list_entry(a, struct semaphore_elem, elem);
-  struct semaphore_elem *second_sema = list_entry(b, struct semaphore_elem, elem);
+/* Records that the current thread acquired LOCK, having started
+   to try at TSC value START.  CONTENDED says whether it had to
+   wait. */
+static void
+lock_stat_acquired (struct lock *lock, uint64_t start, bool contended) 
+{
+  struct lock_class *c = lock->class;
+  enum intr_level old_level;
+  uint64_t now;
+
+  if (!lockstat_enabled)
+    return;
 
-  int first_thread_priority = sema_get_max_priority(&first_sema->semaphore);
-  int second_thread_priority = sema_get_max_priority(&second_sema->semaphore);
+  now = rdtsc ();
+  old_level = intr_disable ();
+  c->acquired++;
+  if (contended) 
+    {
+      uint64_t wait = now - start;
+      c->contended++;
+      c->wait_total += wait;
+      if (wait > c->wait_max)
+        c->wait_max = wait;
+    }
+  intr_set_level (old_level);
+  lock->acquired_at = now;
+}
 
-  return first_thread_priority > second_thread_priority;
+/* Records that the current thread is about to release LOCK. */
+static void
+lock_stat_released (struct lock *lock) 
+{
+  struct lock_class *c = lock->class;
+  enum intr_level old_level;
+  uint64_t hold;
+
+  if (!lockstat_enabled || lock->acquired_at == 0)
+    return;
+
+  hold = rdtsc () - lock->acquired_at;
+  old_level = intr_disable ();
+  c->hold_total += hold;
+  if (hold > c->hold_max)
+    c->hold_max = hold;
+  intr_set_level (old_level);
+}
+
+/* Returns true if lock class A is hotter than B: it made its
+   lockers wait longer in total, or, failing that, was acquired
+   more often. */
+static bool
+lock_class_hotter (const struct lock_class *a, const struct lock_class *b) 
+{
+  if (a->wait_total != b->wait_total)
+    return a->wait_total > b->wait_total;
+  return a->acquired > b->acquired;
+}
+
+/* Prints statistics for the CNT hottest lock classes, hottest
+   first.  The statistics are copied with interrupts off and
+   printed afterward, since printing takes locks of its own. */
+void
+lockstat_print (size_t cnt) 
+{
+  struct lock_class top[LOCKSTAT_TOP];
+  enum intr_level old_level;
+  struct list_elem *e;
+  size_t n = 0;
+  size_t i;
+
+  if (!lockstat_enabled) 
+    {
+      printf ("Lock statistics disabled (use -lockstat).\n");
+      return;
+    }
+  if (cnt > LOCKSTAT_TOP)
+    cnt = LOCKSTAT_TOP;
+
+  /* Insertion sort the hottest CNT classes into TOP. */
+  old_level = intr_disable ();
+  for (e = list_begin (&lock_classes); e != list_end (&lock_classes);
+       e = list_next (e)) 
+    {
+      struct lock_class *c = list_entry (e, struct lock_class, elem);
+
+      if (c->acquired == 0)
+        continue;
+      for (i = n; i > 0 && lock_class_hotter (c, &top[i - 1]); i--)
+        if (i < cnt)
+          top[i] = top[i - 1];
+      if (i < cnt) 
+        {
+          top[i] = *c;
+          if (n < cnt)
+            n++;
+        }
+    }
+  intr_set_level (old_level);
+
+  printf ("Lock statistics (cycles), top %zu:\n", n);
+  for (i = 0; i < n; i++) 
+    {
+      const struct lock_class *c = &top[i];
+      const char *name = c->name[0] == '&' ? c->name + 1 : c->name;
+
+      printf ("%s: %"PRIu64" acquired, %"PRIu64" contended, "
+              "wait %"PRIu64" (max %"PRIu64"), "
+              "hold %"PRIu64" (max %"PRIu64")\n",
+              name, c->acquired, c->contended,
+              c->wait_total, c->wait_max, c->hold_total, c->hold_max);
+    }
 }
 
 /* One semaphore in a list. */
@@ -1,14 +1,19 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <waitq.h>
+#include "threads/interrupt.h"
 
 /* A counting semaphore. */
 struct semaphore 
   {
     unsigned value;             /* Current value. */
-    struct list waiters;        /* List of waiting threads. */
+    struct waitq waiters;       /* Waiting threads, by priority. */
   };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -17,23 +22,74 @@ bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
 
+/* Lock statistics.
+
+   Locks are grouped into classes for the purpose of lock
+   statistics.  Each place in the code that calls lock_init()
+   gets a class of its own, named after the lock expression, and
+   all the locks initialized there add up their statistics in
+   it.  Times are in TSC cycles. */
+struct lock_class 
+  {
+    const char *name;           /* Name for reports. */
+    struct list_elem elem;      /* Element in list of all classes. */
+    bool registered;            /* In the list of all classes? */
+    uint64_t acquired;          /* Number of acquisitions. */
+    uint64_t contended;         /* Acquisitions that had to wait. */
+    uint64_t wait_total;        /* Total time spent waiting. */
+    uint64_t wait_max;          /* Longest wait. */
+    uint64_t hold_total;        /* Total time held. */
+    uint64_t hold_max;          /* Longest hold. */
+  };
+
+/* Initializer for a lock class named NAME. */
+#define LOCK_CLASS_INITIALIZER(NAME) { .name = (NAME) }
+
+void lock_class_init (struct lock_class *, const char *name);
+
+/* If true, locks collect statistics into their classes.
+   Controlled by kernel command-line option "-lockstat". */
+extern bool lockstat_enabled;
+
+/* Number of lock classes lockstat_print() reports at shutdown. */
+#define LOCKSTAT_TOP 10
+
+void lockstat_print (size_t cnt);
+
 /* Lock. */
 struct lock 
   {
     struct thread *holder;      /* Thread holding lock (for debugging). */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+    struct heap waiters;        /* Threads waiting, by priority. */
+    struct heap_elem holder_elem; /* Element in holder's held_locks. */
+    struct lock_class *class;   /* Statistics. */
+    uint64_t acquired_at;       /* TSC when last acquired. */
   };
 
-void lock_init (struct lock *);
+/* Initializes LOCK in a lock class of its own call site. */
+#define lock_init(LOCK)                                                 \
+        do                                                              \
+          {                                                             \
+            static struct lock_class lock_class_ =                      \
+              LOCK_CLASS_INITIALIZER (#LOCK);                           \
+            lock_init_class ((LOCK), &lock_class_);                     \
+          }                                                             \
+        while (0)
+
+void lock_init_class (struct lock *, struct lock_class *);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+int lock_waiter_priority (const struct lock *);
+bool lock_priority_less (const struct heap_elem *, const struct heap_elem *,
+                         void *aux);
 
 /* Condition variable. */
 struct condition 
   {
-    struct list waiters;        /* List of waiting threads. */
+    struct waitq waiters;       /* Waiting semaphore_elems. */
   };
 
 void cond_init (struct condition *);
@@ -41,10 +97,36 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
-/* Custom function in Lab1 */
-int sema_get_max_priority(struct semaphore* sema);
-bool compare_cond_priority (const struct list_elem *a, const struct list_elem *b, void *aux);
+/* Reader-writer lock.
+
+   Any number of readers, or a single writer, may hold the lock.
+   Writers are preferred: once a writer is waiting, new readers
+   wait behind it.  Threads waiting for the lock donate their
+   priority to the writer that holds it or is draining readers. */
+struct rwlock 
+  {
+    struct lock lock;           /* Held by the writer. */
+    struct semaphore drained;   /* Upped when the last reader leaves. */
+    unsigned readers;           /* Number of readers holding the lock. */
+    bool writer_waiting;        /* Writer waiting for readers to leave? */
+  };
+
+/* Initializes RW in a lock class of its own call site. */
+#define rwlock_init(RW)                                                 \
+        do                                                              \
+          {                                                             \
+            static struct lock_class lock_class_ =                      \
+              LOCK_CLASS_INITIALIZER (#RW);                             \
+            rwlock_init_class ((RW), &lock_class_);                     \
+          }                                                             \
+        while (0)
 
+void rwlock_init_class (struct rwlock *, struct lock_class *);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_held_for_write (const struct rwlock *);
 
 /* Optimization barrier.
 
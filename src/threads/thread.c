@@ -1,5 +1,6 @@
 #include "threads/thread.h"
 #include <debug.h>
+#include <inttypes.h>
 #include <stddef.h>
 #include <random.h>
 #include <stdio.h>
@@ -10,8 +11,11 @@
 #include "threads/palloc.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
+#include "threads/tsc.h"
 #include "threads/vaddr.h"
 #include "threads/fp_arithm.h"
+#include "devices/timer.h"
 
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -24,17 +28,42 @@
 
 #define MAX_DEPTH 8
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* A run queue: the processes in THREAD_READY state, that is,
+   processes that are ready to run but not actually running.
+   There is one FIFO queue per priority level,
+   and bit P of `bitmap' is set exactly when queues[P] is
+   non-empty, so that both enqueueing a thread and finding the
+   highest-priority ready thread take constant time.  Threads in
+   the EDF class are kept apart, in a heap ordered by deadline,
+   and run before any of the priority queues.  A throttled EDF
+   thread is in neither until its budget is replenished.  Under
+   the CFS, the priority queues go unused and other threads are
+   kept in a red-black tree ordered by vruntime instead. */
+struct runqueue
+  {
+    struct list queues[PRI_MAX + 1];    /* One FIFO per priority. */
+    uint64_t bitmap;                    /* Non-empty members of queues. */
+    struct heap edf;                    /* EDF threads, by deadline. */
+    struct rbtree cfs;                  /* CFS threads, by vruntime. */
+    int64_t min_vruntime;               /* CFS: never decreases. */
+    unsigned cfs_load;                  /* Sum of weights in cfs. */
+    int cnt;                            /* # of threads in queues. */
+  };
+
+/* The threads that are ready to run. */
+static struct runqueue run_queue;
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
 static struct list all_list;
 
-
-/* List of blocked processes by timer_sleep() function */
-static struct list sleeping_list; 
+/* Table of threads by tid, for thread_find().  A thread is
+   entered once it has a tid and stays until its page is freed,
+   so that a parent can still find a child that has exited.  Tids
+   are handed out sequentially, so taking them modulo the number
+   of buckets spreads them evenly. */
+#define TID_BUCKETS 1024
+static struct list tid_table[TID_BUCKETS];
 
 /* Idle thread. */
 static struct thread *idle_thread;
@@ -58,6 +87,18 @@ static long long idle_ticks;    /* # of timer ticks spent idle. */
 static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
 
+/* Scheduler latency statistics.  wakeup_latency[K] counts the
+   wakeups that took between 2**K and 2**(K+1) - 1 TSC cycles from
+   thread_unblock() until the thread ran. */
+#define LATENCY_BUCKETS 64
+static long long wakeup_latency[LATENCY_BUCKETS];
+static long long voluntary_switches;    /* Switches away by blocking. */
+static long long involuntary_switches;  /* Switches away while ready. */
+
+/* Names of enum thread_wait values, for statistics. */
+static const char *wait_names[WAIT_CNT] =
+  { "other", "sleep", "sema", "lock", "cond", "io" };
+
 /* Scheduling. */
 #define TIME_SLICE 4            /* # of timer ticks to give each thread. */
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
@@ -67,8 +108,68 @@ static unsigned thread_ticks;   /* # of timer ticks since last yield. */
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* Cache of the pages of dead threads.  thread_create() takes a
+   page from here, when there is one, instead of allocating and
+   zeroing a fresh page; init_thread() only has to clear the
+   struct thread at the bottom of the page, since the rest of the
+   page is stack and is never read before it is written. */
+#define THREAD_CACHE_MAX 16
+static void *thread_cache[THREAD_CACHE_MAX];
+static size_t thread_cache_cnt;
+
+/* If false, thread_create() always allocates a fresh page and
+   thread_page_free() always returns it to palloc. */
+bool thread_cache_enabled = true;
+
 int load_avg; 
 
+/* If true, use the completely fair scheduler.
+   Controlled by kernel command-line option "-cfs". */
+bool thread_cfs;
+
+/* Completely fair scheduler.  Each thread accumulates vruntime,
+   its CPU time in ticks scaled by CFS_TICK and weighted by
+   NICE_0_WEIGHT / its weight, and the thread with the least
+   vruntime runs next.  The weight for each nice value is about
+   1.25 times that of the next higher one, so one step in nice
+   changes a thread's share of the CPU by roughly 10%. */
+#define NICE_0_WEIGHT 1024
+#define CFS_TICK (1 << 20)              /* vruntime of a nice 0 tick. */
+#define CFS_LATENCY 8                   /* Ticks to run every thread once. */
+#define CFS_WAKEUP_GRANULARITY CFS_TICK /* Lead needed to preempt. */
+#define CFS_SLEEPER_CREDIT (CFS_LATENCY / 2 * (int64_t) CFS_TICK)
+
+static const unsigned nice_weights[NICE_MAX - NICE_MIN + 1] =
+  {
+    /* -20 */ 88761, 71755, 56483, 46273, 36291,
+    /* -15 */ 29154, 23254, 18705, 14949, 11916,
+    /* -10 */  9548,  7620,  6100,  4904,  3906,
+    /*  -5 */  3121,  2501,  1991,  1586,  1277,
+    /*   0 */  1024,   820,   655,   526,   423,
+    /*   5 */   335,   272,   215,   172,   137,
+    /*  10 */   110,    87,    70,    56,    45,
+    /*  15 */    36,    29,    23,    18,    15,
+    /*  20 */    12,
+  };
+
+/* EDF admission control.  A thread's bandwidth is the fraction
+   of the CPU it reserves, runtime / period, in units of
+   1 / EDF_UNIT.  The EDF class as a whole may reserve at most
+   EDF_BANDWIDTH_MAX, leaving the rest to the priority classes. */
+#define EDF_UNIT 1000000
+#define EDF_BANDWIDTH_MAX (EDF_UNIT / 100 * 95)
+static int64_t edf_bandwidth;   /* Reserved by all EDF threads. */
+
+/* Lazy recent_cpu decay for the MLFQS.  Once per second, the
+   decay factor for that second is recorded here and mlfqs_seconds
+   is incremented.  Only running and ready threads are decayed
+   right away; a blocked thread's recent_cpu is brought up to date
+   by calc_recent_cpu() when it is unblocked, by replaying the
+   decay factors of the seconds it missed. */
+#define DECAY_HISTORY 64        /* # of seconds of decay factors kept. */
+static int decay_history[DECAY_HISTORY];
+static int mlfqs_seconds;
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
@@ -83,6 +184,29 @@ static tid_t allocate_tid (void);
 
 static void set_MLFQS_priority(struct thread *t);
 
+static void ready_queue_push (struct thread *);
+static void ready_queue_remove (struct thread *);
+static int ready_queue_max_priority (struct runqueue *);
+static struct thread *ready_queue_pop (struct runqueue *);
+static int log2_u64 (uint64_t);
+static void print_thread_sched_stats (struct thread *, void *aux);
+static void thread_sleep_expired (void *t_);
+static void *thread_page_alloc (void);
+static void thread_page_free (struct thread *);
+static void tid_table_insert (struct thread *);
+static bool thread_should_yield (void);
+static int64_t edf_bandwidth_of (const struct thread *);
+static void edf_charge (struct thread *);
+static void edf_wakeup (struct thread *);
+static void edf_replenish (void *t_);
+static heap_less_func edf_deadline_less;
+static unsigned cfs_weight (const struct thread *);
+static unsigned cfs_slice (const struct thread *);
+static void cfs_charge (struct thread *);
+static void cfs_update_min_vruntime (struct runqueue *,
+                                     const struct thread *);
+static rb_less_func cfs_vruntime_less;
+
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
    general and it is possible in this case only because loader.S
@@ -99,19 +223,29 @@ static void set_MLFQS_priority(struct thread *t);
 void
 thread_init (void) 
 {
+  int i;
+
   ASSERT (intr_get_level () == INTR_OFF);
 
   lock_init (&tid_lock);
-  list_init (&ready_list);
+  for (i = PRI_MIN; i <= PRI_MAX; i++)
+    list_init (&run_queue.queues[i]);
+  run_queue.bitmap = 0;
+  heap_init (&run_queue.edf, edf_deadline_less, NULL);
+  rbtree_init (&run_queue.cfs, cfs_vruntime_less, NULL);
+  run_queue.min_vruntime = 0;
+  run_queue.cfs_load = 0;
+  run_queue.cnt = 0;
   list_init (&all_list);
-
-  list_init(&sleeping_list); // sleeping_list 초기화
+  for (i = 0; i < TID_BUCKETS; i++)
+    list_init (&tid_table[i]);
 
   /* Set up a thread structure for the running thread. */
   initial_thread = running_thread ();
   init_thread (initial_thread, "main", PRI_DEFAULT);
   initial_thread->status = THREAD_RUNNING;
   initial_thread->tid = allocate_tid ();
+  tid_table_insert (initial_thread);
 }
 
 /* Starts preemptive thread scheduling by enabling interrupts.
@@ -149,17 +283,102 @@ thread_tick (void)
   else
     kernel_ticks++;
 
-  /* Enforce preemption. */
-  if (++thread_ticks >= TIME_SLICE)
+  /* Charge an EDF thread's budget, or a CFS thread's vruntime. */
+  if (t->edf.period != 0)
+    {
+      if (intr_context ())
+        edf_charge (t);
+    }
+  else if (thread_cfs && t != idle_thread)
+    cfs_charge (t);
+
+  /* Enforce preemption.  Outside interrupt context, this is the
+     idle thread catching up on ticks skipped in dynamic tick
+     mode, which gives up the CPU anyway. */
+  if (++thread_ticks >= (thread_cfs ? cfs_slice (t) : TIME_SLICE)
+      && intr_context ())
     intr_yield_on_return ();
 }
 
+/* Charges the running thread for the CPU time since it was last
+   charged, as user time if USER is true and otherwise as system
+   time.  Called whenever the CPU crosses between user mode and
+   the kernel; context switches charge the time themselves. */
+void
+thread_account (bool user)
+{
+  struct thread *t = running_thread ();
+  enum intr_level old_level = intr_disable ();
+  uint64_t now = rdtsc ();
+
+  if (user)
+    t->user_time += now - t->cpu_stamp;
+  else
+    t->system_time += now - t->cpu_stamp;
+  t->cpu_stamp = now;
+  intr_set_level (old_level);
+}
+
+/* Stores the CPU time used by T so far, in nanoseconds, in
+   *USER_NS and *SYSTEM_NS.  T must be the running thread or not
+   running. */
+void
+thread_get_cpu_time (struct thread *t, uint64_t *user_ns,
+                     uint64_t *system_ns)
+{
+  /* The running thread is in the kernel, calling us. */
+  if (t == running_thread ())
+    thread_account (false);
+
+  *user_ns = timer_cycles_to_ns (t->user_time);
+  *system_ns = timer_cycles_to_ns (t->system_time);
+}
+
 /* Prints thread statistics. */
 void
 thread_print_stats (void) 
 {
+  int i;
+
   printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
           idle_ticks, kernel_ticks, user_ticks);
+  printf ("Thread: %lld voluntary, %lld involuntary context switches\n",
+          voluntary_switches, involuntary_switches);
+  for (i = 0; i < LATENCY_BUCKETS; i++)
+    if (wakeup_latency[i] != 0)
+      printf ("Thread: wakeup latency 2^%d cycles: %lld\n",
+              i, wakeup_latency[i]);
+}
+
+/* Prints the thread statistics followed by the scheduler
+   statistics of every live thread. */
+void
+thread_print_sched_stats (void) 
+{
+  enum intr_level old_level;
+
+  thread_print_stats ();
+
+  old_level = intr_disable ();
+  thread_foreach (print_thread_sched_stats, NULL);
+  intr_set_level (old_level);
+}
+
+/* Prints T's scheduler statistics, for thread_foreach(). */
+static void
+print_thread_sched_stats (struct thread *t, void *aux UNUSED) 
+{
+  const struct sched_stats *s = &t->sched;
+  int i;
+
+  printf ("%s (tid %d): %"PRIu32" voluntary, %"PRIu32" involuntary switches, "
+          "run delay %"PRIu64" (max %"PRIu64") cycles\n",
+          t->name, t->tid, s->nvcsw, s->nivcsw,
+          s->run_delay, s->max_run_delay);
+  for (i = 0; i < WAIT_CNT; i++)
+    if (s->wait_time[i] != 0)
+      printf ("%s (tid %d): blocked on %s for %"PRIu64" cycles\n",
+              t->name, t->tid, wait_names[i], s->wait_time[i]);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -190,13 +409,14 @@ thread_create (const char *name, int priority,
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = thread_page_alloc ();
   if (t == NULL)
     return TID_ERROR;
 
   /* Initialize thread. */
   init_thread (t, name, priority);
   tid = t->tid = allocate_tid ();
+  tid_table_insert (t);
 
   /* Stack frame for kernel_thread(). */
   kf = alloc_frame (t, sizeof *kf);
@@ -215,6 +435,7 @@ thread_create (const char *name, int priority,
 
 #ifdef USERPROG
   t->parent_process = thread_current();
+  t->parent_tid = thread_tid ();
 
   t->pcb = palloc_get_page (PAL_ZERO); // for avoding fragmentation
   if (t->pcb == NULL) {    
@@ -242,6 +463,13 @@ thread_create (const char *name, int priority,
   list_push_back (&(t->parent_process->children), &(t->child_elem));
 #endif
 
+  /* Start a new CFS thread one tick past its CPU's min_vruntime.
+     At 0 it would run until it caught up with the threads already
+     there, and it has not slept, so it gets none of the credit
+     that thread_unblock() gives a waking thread. */
+  if (thread_cfs)
+    t->vruntime = run_queue.min_vruntime + CFS_TICK;
+
   /* Add to run queue. */
   thread_unblock (t);
 
@@ -280,77 +508,138 @@ void
 thread_unblock (struct thread *t) 
 {
   enum intr_level old_level;
+  uint64_t now;
   ASSERT (is_thread (t));
 
-  /* ready_list can be accesed in interrupt context by thread_wakeup(). */
+  /* The ready queues can be accesed in interrupt context by
+     timer callbacks. */
   old_level = intr_disable ();
 
   ASSERT (t->status == THREAD_BLOCKED);
 
- /* For priority scheduling: insert elements in descending order of priority. */
-  list_insert_ordered(&ready_list, &t->elem, (list_less_func *) compare_priority_desc, NULL);
+  /* An interrupt that ends the idle thread's halt in dynamic tick
+     mode may wake T and then yield straight to it, so the idle
+     thread would not get to restore the tick.  Catch up now, so
+     that T sees an up-to-date clock and gets preempted on time. */
+  if (idle_thread != NULL && running_thread () == idle_thread)
+    timer_idle_exit ();
+
+  /* Charge the time blocked and start timing the wait to run. */
+  now = rdtsc ();
+  t->sched.wait_time[t->wait] += now - t->sched.stamp;
+  t->sched.stamp = now;
+  t->sched.woken = true;
+
+  /* MLFQS: recent_cpu was not decayed while T was blocked. */
+  if (thread_mlfqs)
+  {
+    calc_recent_cpu(t);
+    set_MLFQS_priority(t);
+  }
+
+  if (t->edf.period != 0)
+    edf_wakeup (t);
+  else if (thread_cfs)
+    {
+      /* Credit T for up to half a latency period of sleep, so
+         that it runs soon, but do not let it make up for all the
+         time it slept at the expense of threads that kept
+         running. */
+      int64_t floor = run_queue.min_vruntime - CFS_SLEEPER_CREDIT;
+      if (t->vruntime < floor)
+        t->vruntime = floor;
+    }
+
+  TRACE (TRACE_WAKEUP, t->tid, t->wait, 0);
+  ready_queue_push (t);
   t->status = THREAD_READY;
 
+  /* A periodic EDF thread is typically woken by a timer, and
+     should not have to wait for the end of the current time
+     slice to run.  Under the CFS, neither should a thread that
+     has slept long enough to be well behind the running one. */
+  if ((t->edf.period != 0 || thread_cfs) && intr_context ()
+      && thread_should_yield ())
+    intr_yield_on_return ();
+
   intr_set_level (old_level);
 }
 
 void
 thread_sleep(int64_t wakeup_time)
 {
-  /* sleeping_list can be accessed in interrupt context by thread_wakeup function. 
-  locking on sleeping_list may lead to dead lock situations if timer interrupt occurs
-  in the middle of thread_sleep function. */
+  /* The sleep timer expires in interrupt context. If the timer interrupt 
+  occurred between arming it and blocking, the thread could be unblocked 
+  before it is blocked. */
   enum intr_level old_level = intr_disable(); 
 
   struct thread *cur = thread_current();
 
   /* idle thread must not be put to sleep. Remember that the idle thread is selected by 
-  the scheduler when there are no threads in the ready_list. */
+  the scheduler when there are no threads in the ready queues. */
   ASSERT (cur != idle_thread); 
 
   cur->wake_up_time = wakeup_time; 
 
-  /* insert elements to sleeping_list in ascending order of wake_up_time */
-  list_insert_ordered(&sleeping_list, &cur->elem, (list_less_func *) compare_wakeup_ticks, NULL); 
+  /* the timer wheel calls thread_sleep_expired() once wakeup_time is reached */
+  timer_event_arm(&cur->sleep_timer, wakeup_time);
 
   /* change the state of sleeping thread into THREAD_BLOCK. Then call schedule(). */
+  cur->wait = WAIT_SLEEP;
   thread_block();
+  cur->wait = WAIT_OTHER;
 
   intr_set_level(old_level);
 }
 
-void 
-thread_wakeup(int64_t ticks) 
+/* Sleep timer callback: change state of T into THREAD_READY. 
+Runs in the timer interrupt. */
+static void
+thread_sleep_expired(void *t_)
 {
-  struct thread *t;
-  struct list_elem *e; 
+  struct thread *t = t_;
+  ASSERT(is_thread(t));
 
-  for(e = list_begin(&sleeping_list); e != list_end(&sleeping_list);)
-  {
-    t = list_entry(e, struct thread, elem);
-    ASSERT(is_thread(t))
-
-    if(t->wake_up_time > ticks) // too early to wake up
-      break; 
-    else // time to wake up
-    {
-      e = list_remove(e); // Return elem->next; Thus we don't need to call list_next(e);
-      thread_unblock(t); // change state of t into THREAD_READY.
-    }
-  }
+  thread_unblock(t);
 }
 
 void
 thread_preempt()
 {
-  if(!list_empty(&ready_list))
-  {
-    struct thread *cur = thread_current();
-    struct thread *next = list_entry(list_front(&ready_list), struct thread, elem);
+  if (thread_should_yield ())
+    thread_yield();
+}
 
-    if(cur->priority < next->priority)
-      thread_yield();
-  }
+/* Returns true if a ready thread should run instead of the
+   running thread: an EDF thread with an earlier deadline, any
+   EDF thread if the running thread is not EDF, or otherwise a
+   thread of higher priority, or under the CFS a thread whose
+   vruntime is well behind. */
+static bool
+thread_should_yield (void)
+{
+  struct thread *cur = running_thread ();
+  struct runqueue *rq = &run_queue;
+
+  ASSERT (is_thread (cur));
+
+  if (!heap_empty (&rq->edf))
+    {
+      struct thread *t = heap_entry (heap_top (&rq->edf),
+                                     struct thread, edf.elem);
+      if (cur->edf.period == 0 || t->edf.deadline < cur->edf.deadline)
+        return true;
+    }
+  if (cur->edf.period != 0)
+    return false;
+  if (thread_cfs)
+    {
+      struct rb_elem *e = rbtree_min (&rq->cfs);
+      return (cur != idle_thread && e != NULL
+              && (rbtree_entry (e, struct thread, cfs_elem)->vruntime
+                  + CFS_WAKEUP_GRANULARITY < cur->vruntime));
+    }
+  return cur->priority < ready_queue_max_priority (rq);
 }
 
 /* Returns the name of the running thread. */
@@ -401,6 +690,7 @@ thread_exit (void)
      and schedule another process.  That process will destroy us
      when it calls thread_schedule_tail(). */
   intr_disable ();
+  edf_bandwidth -= edf_bandwidth_of (thread_current ());
   list_remove (&thread_current()->allelem);
   thread_current ()->status = THREAD_DYING;
   schedule ();
@@ -420,9 +710,9 @@ thread_yield (void)
   old_level = intr_disable ();
   
   /* Check the next_thread_to_run function. 
-  idle thread should not be inserted in ready_list. */
+  idle thread should not be inserted in the ready queues. */
   if (cur != idle_thread)
-    list_insert_ordered(&ready_list, &cur->elem, (list_less_func *) compare_priority_desc, NULL);
+    ready_queue_push (cur);
  
   cur->status = THREAD_READY;
   schedule ();
@@ -458,10 +748,10 @@ thread_set_priority (int new_priority)
     return;
 
   thread_current ()->original_priority = new_priority;
-  thread_reflect_donation_list();
+  thread_refresh_priority (thread_current ());
 
   /* After change the priority of current thread, Check whether 
-  it has lower prirority than ready_list */
+  it has lower prirority than the ready queues */
   thread_preempt();
 }
 
@@ -472,77 +762,254 @@ thread_get_priority (void)
   return thread_current ()->priority;
 }
 
-/* Consider the nested donation priority */
+/* Recomputes T's priority from its own base priority and the
+   highest-priority waiter on any lock it holds.  Returns true if
+   T's priority changed.  Held locks are kept in a heap ordered by
+   their top waiter, so this takes constant time. */
+bool
+thread_refresh_priority (struct thread *t)
+{
+  int priority = t->original_priority;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  if (!heap_empty (&t->held_locks))
+    {
+      struct lock *top = heap_entry (heap_top (&t->held_locks),
+                                     struct lock, holder_elem);
+      int donated = lock_waiter_priority (top);
+      if (donated > priority)
+        priority = donated;
+    }
+  intr_set_level (old_level);
+
+  if (priority == t->priority)
+    return false;
+  thread_update_priority (t, priority);
+  return true;
+}
+
+/* Propagates T's priority up the chain of lock holders that T is
+   (transitively) waiting on, at most MAX_DEPTH links deep.  Each
+   link re-keys T in its lock's waiter heap and the lock in its
+   holder's held-lock heap, so a donation costs O(depth * log n).
+   The walk stops as soon as a holder's priority is unaffected. */
 void
-thread_donate_priority(struct thread *holder, int depth)
+thread_donate_priority (struct thread *t)
 {
-  depth = 0; 
-  struct thread *trying_thread = thread_current();
+  int depth;
 
-  for(; trying_thread->lock_wait != NULL && depth < MAX_DEPTH; depth++, 
-    trying_thread = trying_thread->lock_wait->holder)
-  {
-    if(trying_thread->priority > trying_thread->lock_wait->holder->priority)
-      trying_thread->lock_wait->holder->priority = trying_thread->priority;
-  }
+  ASSERT (intr_get_level () == INTR_OFF);
 
+  for (depth = 0; t->lock_wait != NULL && depth < MAX_DEPTH; depth++)
+    {
+      struct lock *lock = t->lock_wait;
+      struct thread *holder = lock->holder;
+
+      heap_update (&lock->waiters, &t->waiter_elem);
+      if (holder == NULL)
+        break;
+      heap_update (&holder->held_locks, &lock->holder_elem);
+      if (!thread_refresh_priority (holder))
+        break;
+      t = holder;
+    }
 }
 
-/* Consider the nested donation situation */
-void thread_donate_priority_test(void)
+/* Moves the current thread into the EDF class, with a budget of
+   RUNTIME timer ticks of CPU time in every PERIOD ticks, or, if
+   PERIOD is 0, back into its priority class.  The first period
+   starts now.
+
+   Returns false, changing nothing, if RUNTIME is not between 1
+   and PERIOD or if admitting the thread would reserve more than
+   EDF_BANDWIDTH_MAX of the CPU for EDF threads. */
+bool
+thread_set_deadline (int64_t period, int64_t runtime)
 {
-  int depth = 0;
-  struct thread *trying_thread = thread_current();
-  struct thread *holder;
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  int64_t bandwidth;
 
-  while(trying_thread->lock_wait != NULL && depth < MAX_DEPTH)
-  {
-    holder = trying_thread->lock_wait->holder;
-    
-    if (holder->priority < trying_thread->priority)
+  ASSERT (cur != idle_thread);
+
+  if (period < 0 || (period > 0 && (runtime < 1 || runtime > period)))
+    return false;
+  bandwidth = period > 0 ? runtime * EDF_UNIT / period : 0;
+
+  old_level = intr_disable ();
+  if (edf_bandwidth - edf_bandwidth_of (cur) + bandwidth > EDF_BANDWIDTH_MAX)
     {
-      holder->priority = trying_thread->priority;
+      intr_set_level (old_level);
+      return false;
     }
+  edf_bandwidth += bandwidth - edf_bandwidth_of (cur);
 
-    trying_thread = holder;
-    depth++;   
-  }
+  cur->edf.period = period;
+  cur->edf.runtime = runtime;
+  cur->edf.deadline = timer_ticks () + period;
+  cur->edf.budget = runtime;
+  cur->edf.throttled = false;
+  intr_set_level (old_level);
+
+  /* Leaving the EDF class may let someone else run. */
+  thread_preempt ();
+  return true;
+}
+
+/* Returns the share of the CPU that T reserves as an EDF thread,
+   in units of 1 / EDF_UNIT. */
+static int64_t
+edf_bandwidth_of (const struct thread *t)
+{
+  return t->edf.period != 0 ? t->edf.runtime * EDF_UNIT / t->edf.period : 0;
 }
 
-void thread_remove_donation_elem(struct thread *releasing_thread, struct lock *lock)
+/* Charges T, the running EDF thread, for a timer tick.  Once its
+   budget is used up, T is throttled until its deadline, when
+   edf_replenish() lets it run again; if the deadline has already
+   passed, T starts a new period at once.  Either way T yields, so
+   that the thread with the earliest deadline runs next.  Called
+   from the timer interrupt. */
+static void
+edf_charge (struct thread *t)
 {
-    struct list_elem *e; 
-    struct thread *donated_thread; 
+  int64_t now = timer_ticks ();
 
-    for (e = list_begin(&releasing_thread->donation_list); e != list_end(&releasing_thread->donation_list);)
+  if (--t->edf.budget > 0)
+    return;
+
+  if (t->edf.deadline > now)
     {
-      donated_thread = list_entry(e, struct thread, donation_elem);
-      ASSERT(is_thread(donated_thread));
+      t->edf.throttled = true;
+      timer_event_arm (&t->edf.replenish, t->edf.deadline);
+    }
+  else
+    {
+      t->edf.deadline = now + t->edf.period;
+      t->edf.budget = t->edf.runtime;
+    }
+  intr_yield_on_return ();
+}
 
-      if (donated_thread->lock_wait == lock)
-      {
-        e = list_remove(e);
-        donated_thread->lock_wait = NULL;
-      }
-      else 
-        e = list_next(e);
+/* Applies the constant bandwidth server's wakeup rule to T, an
+   EDF thread being unblocked: if T's remaining budget cannot be
+   used up by its current deadline without exceeding T's
+   bandwidth, T starts a new period now.  This keeps a thread
+   that blocked for a while from crowding out the others. */
+static void
+edf_wakeup (struct thread *t)
+{
+  int64_t now = timer_ticks ();
+
+  if (t->edf.deadline <= now
+      || t->edf.budget * t->edf.period
+         > (t->edf.deadline - now) * t->edf.runtime)
+    {
+      t->edf.deadline = now + t->edf.period;
+      t->edf.budget = t->edf.runtime;
     }
 }
 
-/* Addressing multiple donation situation */
-void thread_reflect_donation_list(void)
+/* Timer callback that ends the throttling of EDF thread T_ at
+   its deadline, giving it a new budget and a new deadline one
+   period later.  Runs in the timer interrupt. */
+static void
+edf_replenish (void *t_)
 {
-  struct thread *cur = thread_current();
-  cur->priority = cur->original_priority;
+  struct thread *t = t_;
+  int64_t now = timer_ticks ();
 
-  if(!list_empty(&cur->donation_list)) 
-  {
-    struct thread *max = list_entry(list_max(&cur->donation_list, compare_priority_desc, NULL), 
-                                      struct thread, donation_elem);
+  ASSERT (is_thread (t));
+  ASSERT (t->edf.throttled);
 
-    if (max->priority > cur->priority)
-      cur->priority = max->priority;
-  }
+  t->edf.throttled = false;
+  t->edf.deadline += t->edf.period;
+  if (t->edf.deadline <= now)
+    t->edf.deadline = now + t->edf.period;
+  t->edf.budget = t->edf.runtime;
+
+  if (t->status == THREAD_READY)
+    {
+      ready_queue_push (t);
+      if (thread_should_yield ())
+        intr_yield_on_return ();
+    }
+}
+
+/* Orders EDF threads so that the earliest deadline is on top of
+   the heap. */
+static bool
+edf_deadline_less (const struct heap_elem *a_, const struct heap_elem *b_,
+                   void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, edf.elem);
+  const struct thread *b = heap_entry (b_, struct thread, edf.elem);
+
+  return a->edf.deadline > b->edf.deadline;
+}
+
+/* Returns T's CFS weight, which depends on its nice value. */
+static unsigned
+cfs_weight (const struct thread *t)
+{
+  ASSERT (NICE_MIN <= t->nice && t->nice <= NICE_MAX);
+
+  return nice_weights[t->nice - NICE_MIN];
+}
+
+/* Returns the number of ticks that T, the running thread, may
+   run before it must give other CFS threads a turn: its share,
+   by weight, of CFS_LATENCY, but at least one tick. */
+static unsigned
+cfs_slice (const struct thread *t)
+{
+  unsigned weight = cfs_weight (t);
+  unsigned slice;
+
+  slice = CFS_LATENCY * weight / (run_queue.cfs_load + weight);
+  return slice > 0 ? slice : 1;
+}
+
+/* Charges T, the running thread, for a timer tick of CPU time,
+   weighted by its nice value. */
+static void
+cfs_charge (struct thread *t)
+{
+  t->vruntime += (unsigned) CFS_TICK * NICE_0_WEIGHT / cfs_weight (t);
+  cfs_update_min_vruntime (&run_queue, t);
+}
+
+/* Advances RQ's min_vruntime to the least vruntime of RUNNING,
+   the running thread, and the threads in RQ.
+   min_vruntime never goes backward, so that a thread that
+   blocked cannot come back with a vruntime far behind the
+   others. */
+static void
+cfs_update_min_vruntime (struct runqueue *rq, const struct thread *running)
+{
+  struct rb_elem *e = rbtree_min (&rq->cfs);
+  int64_t min = running->vruntime;
+
+  if (e != NULL)
+    {
+      int64_t v = rbtree_entry (e, struct thread, cfs_elem)->vruntime;
+      if (v < min)
+        min = v;
+    }
+  if (min > rq->min_vruntime)
+    rq->min_vruntime = min;
+}
+
+/* Orders CFS threads by vruntime. */
+static bool
+cfs_vruntime_less (const struct rb_elem *a_, const struct rb_elem *b_,
+                   void *aux UNUSED)
+{
+  const struct thread *a = rbtree_entry (a_, struct thread, cfs_elem);
+  const struct thread *b = rbtree_entry (b_, struct thread, cfs_elem);
+
+  return a->vruntime < b->vruntime;
 }
 
 /* Sets the current thread's nice value to NICE. */
@@ -555,9 +1022,13 @@ thread_set_nice (int nice)
 
   enum intr_level old_level = intr_disable();
 
+  if (nice < NICE_MIN)
+    nice = NICE_MIN;
+  else if (nice > NICE_MAX)
+    nice = NICE_MAX;
   cur->nice = nice;
-  set_MLFQS_priority(cur);
-  // list_sort(&ready_list, compare_priority_desc, NULL); 
+  if (!thread_cfs)
+    set_MLFQS_priority(cur);
   
   thread_preempt();
 
@@ -578,14 +1049,43 @@ thread_get_nice (void)
   return nice;
 }
 
-//recent_cpu = decay * recent_cpu + nice
 //decay = 2*load_avg / (2*load_avg + 1)
+/* Record this second's decay factor, which every thread's recent_cpu 
+is decayed by, now or lazily. Must follow calc_load_avg(). */
+void
+calc_decay()
+{
+  decay_history[mlfqs_seconds % DECAY_HISTORY] = 
+    fp_div(fp_mul_int(load_avg, 2), fp_add_int(fp_mul_int(load_avg, 2), 1));
+  mlfqs_seconds++;
+}
+
+//recent_cpu = decay * recent_cpu + nice
+/* Apply every decay T has missed since its recent_cpu was last updated. 
+For gaps longer than DECAY_HISTORY, the seconds no longer in the history 
+are applied in closed form with the oldest recorded decay d:
+  recent_cpu = d^m * recent_cpu + nice * (1 - d^m) / (1 - d) */
 void 
 calc_recent_cpu(struct thread *t)
 {
+  int missed = mlfqs_seconds - t->recent_cpu_epoch;
+  int second;
+
+  if (missed > DECAY_HISTORY)
+  {
+    int d = decay_history[mlfqs_seconds % DECAY_HISTORY];
+    int d_m = fp_pow_int(d, missed - DECAY_HISTORY);
+
+    t->recent_cpu = fp_add(fp_mul(d_m, t->recent_cpu), 
+      fp_div(fp_mul_int(fp_sub(int_to_fp(1), d_m), t->nice), fp_sub(int_to_fp(1), d)));
+    missed = DECAY_HISTORY;
+  }
+
   //nice 와 decay 를 이용해 쓰레드의 recent_cpu를 계산
-  int decay = fp_div(fp_mul_int(load_avg, 2), fp_add_int(fp_mul_int(load_avg, 2), 1));
-  t->recent_cpu = fp_add_int(fp_mul(decay, t->recent_cpu) , t->nice);
+  for (second = mlfqs_seconds - missed; second < mlfqs_seconds; second++)
+    t->recent_cpu = fp_add_int(fp_mul(decay_history[second % DECAY_HISTORY], t->recent_cpu), t->nice);
+
+  t->recent_cpu_epoch = mlfqs_seconds;
 }
 
 /* increment current therad's recent_cpu */
@@ -607,26 +1107,40 @@ calc_load_avg()
   //load_avg 계산
   int ready_threads;
 
-  /*ready_threads = # of threads in ready_list + # of running thread (0 if currnet thread is idle thread, else 1)*/
+  /*ready_threads = # of threads in ready queues + # of running thread (0 if currnet thread is idle thread, else 1)*/
   if(thread_current() != idle_thread) 
-    ready_threads = list_size(&ready_list) + 1;
+    ready_threads = run_queue.cnt + 1;
   else 
-    ready_threads = list_size(&ready_list);
+    ready_threads = run_queue.cnt;
  
   load_avg = fp_add(fp_mul(fp_div(int_to_fp(59),int_to_fp(60)), load_avg), fp_div_int(int_to_fp(ready_threads), 60)); //1/60 * ready_threads
 }
 
-/* increase all thread's recent_cpu value */
+/* Decay recent_cpu of the running thread and of every ready thread, 
+and move ready threads whose priority changed to their new queue. 
+Blocked threads are left alone, see calc_recent_cpu(). */
 void 
 recent_cpu_update()
 {
   struct thread *t;
+  struct list_elem *e, *next;
+  int priority;
 
-  for(struct list_elem *e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
-  {
-    t = list_entry(e, struct thread, allelem);
-    calc_recent_cpu(t);
-  }
+  calc_decay();
+
+  calc_recent_cpu(thread_current());
+  set_MLFQS_priority(thread_current());
+
+  /* A thread moved to a lower queue is visited again, which is harmless: 
+  it is already up to date. */
+  for(priority = PRI_MAX; priority >= PRI_MIN; priority--)
+    for(e = list_begin(&run_queue.queues[priority]); e != list_end(&run_queue.queues[priority]); e = next)
+    {
+      next = list_next(e);
+      t = list_entry(e, struct thread, elem);
+      calc_recent_cpu(t);
+      set_MLFQS_priority(t);
+    }
 }
 
 /* Returns 100 times the system load average. */
@@ -663,28 +1177,194 @@ void set_MLFQS_priority(struct thread *t)
   int mlfqs_priority = fp_to_int_rounding(fp_sub(fp_sub(int_to_fp(PRI_MAX), fp_div_int(t->recent_cpu, 4)), fp_mul_int(int_to_fp(t->nice), 2)));
   
   if(mlfqs_priority > PRI_MAX) 
-    t->priority = PRI_MAX;
+    mlfqs_priority = PRI_MAX;
   else if(mlfqs_priority < PRI_MIN) 
-    t->priority = PRI_MIN;//범위 넘어갈 경우
-  else 
-    t->priority = mlfqs_priority;
+    mlfqs_priority = PRI_MIN;//범위 넘어갈 경우
+
+  thread_update_priority(t, mlfqs_priority);
 }
 
-/* Update MLFQS priority of all threads then, sort ready_list 
-in descending order of priority */
-void MLFQS_priority_update(){ //모든 쓰레드를 MLFQS priority로 업데이트
+/* Update MLFQS priority of the running thread. Between two seconds, 
+it is the only thread whose recent_cpu changes, so the priorities of 
+all other threads are still current. */
+void MLFQS_priority_update(){
 
-  struct thread *t;
+  set_MLFQS_priority(thread_current());
+}
 
-  for(struct list_elem *e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
-  {
-    t = list_entry(e, struct thread, allelem);
-    set_MLFQS_priority(t);
-  }
+/* Sets T's effective priority to PRIORITY.  If T is waiting in
+   the ready queues, it is moved to the tail of the queue for its
+   new priority so that next_thread_to_run() sees the change.
+   If T is blocked in a wait queue, it is re-keyed there so that
+   the next signal wakes it in its new order. */
+void
+thread_update_priority (struct thread *t, int priority)
+{
+  enum intr_level old_level;
+
+  ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+
+  if (t->priority == priority)
+    return;
+
+  old_level = intr_disable ();
+  if (t->status == THREAD_READY)
+    {
+      ready_queue_remove (t);
+      t->priority = priority;
+      ready_queue_push (t);
+    }
+  else
+    {
+      t->priority = priority;
+      if (t->status == THREAD_BLOCKED && t->wait_entry != NULL)
+        waitq_rekey (t->wait_entry, priority);
+    }
+  intr_set_level (old_level);
+}
+
+/* Appends T to the ready queue for its priority.  Interrupts
+   must be off. */
+static void
+ready_queue_push (struct thread *t)
+{
+  struct runqueue *rq = &run_queue;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->edf.period == 0 && thread_cfs)
+    {
+      rbtree_insert (&rq->cfs, &t->cfs_elem);
+      rq->cfs_load += cfs_weight (t);
+      rq->cnt++;
+    }
+  else if (t->edf.period == 0)
+    {
+      list_push_back (&rq->queues[t->priority], &t->elem);
+      rq->bitmap |= (uint64_t) 1 << t->priority;
+      rq->cnt++;
+    }
+  else if (!t->edf.throttled)
+    {
+      heap_push (&rq->edf, &t->edf.elem);
+      rq->cnt++;
+    }
+}
+
+/* Removes T from its run queue.  Interrupts must be off. */
+static void
+ready_queue_remove (struct thread *t)
+{
+  struct runqueue *rq = &run_queue;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->edf.period == 0 && thread_cfs)
+    {
+      rbtree_remove (&rq->cfs, &t->cfs_elem);
+      rq->cfs_load -= cfs_weight (t);
+      rq->cnt--;
+    }
+  else if (t->edf.period == 0)
+    {
+      list_remove (&t->elem);
+      if (list_empty (&rq->queues[t->priority]))
+        rq->bitmap &= ~((uint64_t) 1 << t->priority);
+      rq->cnt--;
+    }
+  else if (!t->edf.throttled)
+    {
+      heap_remove (&rq->edf, &t->edf.elem);
+      rq->cnt--;
+    }
+}
+
+/* Returns the highest priority of any thread in RQ, or -1 if RQ
+   is empty.  Uses the `bsr' instruction on each half of RQ's
+   bitmap, so this takes constant time. */
+static int
+ready_queue_max_priority (struct runqueue *rq)
+{
+  uint64_t bitmap = rq->bitmap;
+  uint32_t half;
+  int bit;
+
+  if (bitmap == 0)
+    return -1;
+
+  half = bitmap >> 32;
+  if (half != 0)
+    {
+      asm ("bsrl %1, %0" : "=r" (bit) : "rm" (half));
+      return bit + 32;
+    }
+
+  half = bitmap;
+  asm ("bsrl %1, %0" : "=r" (bit) : "rm" (half));
+  return bit;
+}
+
+/* Removes and returns the EDF thread with the earliest deadline
+   in RQ, or if there is none the highest-priority thread, or
+   under the CFS the thread with the least vruntime, or a null
+   pointer if RQ is empty.  Interrupts must be off. */
+static struct thread *
+ready_queue_pop (struct runqueue *rq)
+{
+  struct thread *t = NULL;
+  int priority;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  priority = ready_queue_max_priority (rq);
+  if (!heap_empty (&rq->edf))
+    {
+      t = heap_entry (heap_pop (&rq->edf), struct thread, edf.elem);
+      rq->cnt--;
+    }
+  else if (!rbtree_empty (&rq->cfs))
+    {
+      t = rbtree_entry (rbtree_min (&rq->cfs), struct thread, cfs_elem);
+      rbtree_remove (&rq->cfs, &t->cfs_elem);
+      rq->cfs_load -= cfs_weight (t);
+      rq->cnt--;
+      cfs_update_min_vruntime (rq, t);
+    }
+  else if (priority >= 0)
+    {
+      t = list_entry (list_pop_front (&rq->queues[priority]),
+                      struct thread, elem);
+      if (list_empty (&rq->queues[priority]))
+        rq->bitmap &= ~((uint64_t) 1 << priority);
+      rq->cnt--;
+    }
+
+  return t;
+}
+
+/* Returns the base-2 logarithm of X, rounded down, or 0 if X is
+   0. */
+static int
+log2_u64 (uint64_t x)
+{
+  uint32_t half;
+  int bit;
+
+  half = x >> 32;
+  if (half != 0)
+    {
+      asm ("bsrl %1, %0" : "=r" (bit) : "rm" (half));
+      return bit + 32;
+    }
 
-  list_sort(&ready_list, compare_priority_desc, NULL);
+  half = x;
+  if (half == 0)
+    return 0;
+  asm ("bsrl %1, %0" : "=r" (bit) : "rm" (half));
+  return bit;
 }
 
+
 
 /* Idle thread.  Executes when no other thread is ready to run.
 
@@ -704,10 +1384,16 @@ idle (void *idle_started_ UNUSED)
 
   for (;;) 
     {
-      /* Let someone else run. */
+      /* Let someone else run.  In dynamic tick mode, first catch
+         up on the ticks that passed while the CPU was halted. */
       intr_disable ();
+      timer_idle_exit ();
       thread_block ();
 
+      /* Nothing is ready to run.  In dynamic tick mode, stop the
+         periodic tick until the next timer deadline. */
+      timer_idle_enter ();
+
       /* Re-enable interrupts and wait for the next one.
 
          The `sti' instruction disables interrupts until the
@@ -773,12 +1459,19 @@ init_thread (struct thread *t, const char *name, int priority)
   t->stack = (uint8_t *) t + PGSIZE;
   t->priority = priority;
   t->original_priority = priority;
-  t->nice = 0;
+  t->nice = NICE_DEFAULT;
   t->recent_cpu = 0;
+  t->recent_cpu_epoch = mlfqs_seconds;
   t->magic = THREAD_MAGIC;
+  t->wait = WAIT_OTHER;
+  t->sched.stamp = t->cpu_stamp = rdtsc ();
 
-  list_init(&t->donation_list);
+  heap_init (&t->held_locks, lock_priority_less, NULL);
+  timer_event_init(&t->sleep_timer, thread_sleep_expired, t);
+  timer_event_init (&t->edf.replenish, edf_replenish, t);
+#ifdef USERPROG
   list_init(&t->children);
+#endif
 
   list_init(&t->mmap_list);
 
@@ -787,6 +1480,54 @@ init_thread (struct thread *t, const char *name, int priority)
   intr_set_level (old_level);
 }
 
+/* Returns a page for a new thread, from the cache of dead
+   threads' pages if possible, or a null pointer if no page is
+   available.  Only the struct thread at the start of a cached
+   page is guaranteed to be initialized, by init_thread(). */
+static void *
+thread_page_alloc (void) 
+{
+  void *page = NULL;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  if (thread_cache_cnt > 0)
+    page = thread_cache[--thread_cache_cnt];
+  intr_set_level (old_level);
+
+  return page != NULL ? page : palloc_get_page (PAL_ZERO);
+}
+
+/* Frees the page of T, which must be dead: it has exited and
+   been switched away from for the last time.  The page goes to
+   the cache of thread pages unless the cache is full. */
+static void
+thread_page_free (struct thread *t) 
+{
+  enum intr_level old_level;
+
+  ASSERT (is_thread (t));
+  ASSERT (t != running_thread ());
+  ASSERT (t->status == THREAD_DYING);
+
+  old_level = intr_disable ();
+  list_remove (&t->tid_elem);
+
+  /* Make sure a stale pointer to T is not taken for a live
+     thread. */
+  t->magic = 0;
+
+  if (thread_cache_enabled && thread_cache_cnt < THREAD_CACHE_MAX) 
+    {
+      thread_cache[thread_cache_cnt++] = t;
+      t = NULL;
+    }
+  intr_set_level (old_level);
+
+  if (t != NULL)
+    palloc_free_page (t);
+}
+
 /* Allocates a SIZE-byte frame at the top of thread T's stack and
    returns a pointer to the frame's base. */
 static void *
@@ -808,10 +1549,9 @@ alloc_frame (struct thread *t, size_t size)
 static struct thread *
 next_thread_to_run (void) 
 {
-  if (list_empty (&ready_list))
-    return idle_thread;
-  else
-    return list_entry (list_pop_front (&ready_list), struct thread, elem);
+  struct thread *t = ready_queue_pop (&run_queue);
+
+  return t != NULL ? t : idle_thread;
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -837,8 +1577,25 @@ thread_schedule_tail (struct thread *prev)
   
   ASSERT (intr_get_level () == INTR_OFF);
 
-  /* Mark us as running. */
+  /* Mark us as running, and account for the time we spent
+     ready. */
   cur->status = THREAD_RUNNING;
+  cur->cpu_stamp = rdtsc ();
+  if (cur != idle_thread)
+    {
+      uint64_t now = rdtsc ();
+      uint64_t delay = now - cur->sched.stamp;
+
+      cur->sched.run_delay += delay;
+      if (delay > cur->sched.max_run_delay)
+        cur->sched.max_run_delay = delay;
+      if (cur->sched.woken)
+        {
+          wakeup_latency[log2_u64 (delay)]++;
+          cur->sched.woken = false;
+        }
+      cur->sched.stamp = now;
+    }
 
   /* Start new time slice. */
   thread_ticks = 0;
@@ -856,10 +1613,44 @@ thread_schedule_tail (struct thread *prev)
   if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread) 
     {
       ASSERT (prev != cur);
-      // palloc_free_page (prev);
+#ifdef USERPROG
+      /* With user programs, the parent reads its children's exit
+         status, so a child's page is freed only once the parent
+         has also called thread_reap() on it. */
+      if (prev->reaped)
+#endif
+        thread_page_free (prev);
     }
 }
 
+#ifdef USERPROG
+/* Called by T's parent when it no longer needs T, which must
+   have exited or be about to: T has woken its parent and will
+   not block again before it dies.  Frees T's page at once if T
+   was switched away from for the last time, or otherwise leaves
+   it for thread_schedule_tail() to free after that switch. */
+void
+thread_reap (struct thread *t) 
+{
+  enum intr_level old_level;
+  bool dead;
+
+  ASSERT (is_thread (t));
+  ASSERT (t != running_thread ());
+
+  /* A thread is seen as THREAD_DYING by other threads only after
+     it has switched away, since it sets that status with
+     interrupts off just before the switch. */
+  old_level = intr_disable ();
+  t->reaped = true;
+  dead = t->status == THREAD_DYING;
+  intr_set_level (old_level);
+
+  if (dead)
+    thread_page_free (t);
+}
+#endif
+
 /* Schedules a new process.  At entry, interrupts must be off and
    the running process's state must have been changed from
    running to some other state.  This function finds another
@@ -878,8 +1669,31 @@ schedule (void)
   ASSERT (cur->status != THREAD_RUNNING);
   ASSERT (is_thread (next));
 
+  /* Count the switch and note when CUR stopped running. */
+  if (cur != idle_thread)
+    {
+      if (cur->status == THREAD_READY)
+        {
+          cur->sched.nivcsw++;
+          involuntary_switches++;
+        }
+      else
+        {
+          cur->sched.nvcsw++;
+          voluntary_switches++;
+        }
+      cur->sched.stamp = rdtsc ();
+    }
+
+  /* Everything since CUR last crossed into the kernel was spent
+     there. */
+  cur->system_time += rdtsc () - cur->cpu_stamp;
+
   if (cur != next)
-    prev = switch_threads (cur, next);
+    {
+      TRACE (TRACE_SWITCH, next->tid, cur->status, 0);
+      prev = switch_threads (cur, next);
+    }
   thread_schedule_tail (prev);
 }
 
@@ -903,36 +1717,61 @@ uint32_t thread_stack_ofs = offsetof (struct thread, stack);
 
 
 bool
-compare_wakeup_ticks( const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
+compare_priority_desc(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
 {
   struct thread *t1 = list_entry(a, struct thread, elem);
   struct thread *t2 = list_entry(b, struct thread, elem);
 
-  return t1->wake_up_time < t2->wake_up_time;
+  return t1->priority > t2->priority;
 }
 
-bool
-compare_priority_desc(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
+/* Returns the running, ready or blocked thread with the given
+   TID, or a null pointer if there is none. */
+struct thread *
+get_thread_by_tid (tid_t tid) 
 {
-  struct thread *t1 = list_entry(a, struct thread, elem);
-  struct thread *t2 = list_entry(b, struct thread, elem);
+  struct thread *t = thread_find (tid);
 
-  return t1->priority > t2->priority;
+  return t != NULL && t->status != THREAD_DYING ? t : NULL;
 }
 
+/* Returns the thread with the given TID, including one that has
+   exited but whose struct thread has not been freed yet, or a
+   null pointer if there is none.  Takes constant time for any
+   reasonable number of threads. */
 struct thread *
-get_thread_by_tid(tid_t tid) {
-    struct list_elem *e;
+thread_find (tid_t tid) 
+{
+  struct list *bucket = &tid_table[(unsigned) tid % TID_BUCKETS];
+  struct thread *found = NULL;
+  enum intr_level old_level;
+  struct list_elem *e;
 
-    /* 모든 스레드 리스트(all_list)를 순회하며 tid가 일치하는 스레드를 찾음 */
-    for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e)) 
+  old_level = intr_disable ();
+  for (e = list_begin (bucket); e != list_end (bucket); e = list_next (e)) 
     {
-        struct thread *t = list_entry(e, struct thread, allelem);
-        if (t->tid == tid) 
+      struct thread *t = list_entry (e, struct thread, tid_elem);
+      if (t->tid == tid) 
         {
-            return t;  
+          found = t;
+          break;
         }
     }
+  intr_set_level (old_level);
+
+  return found;
+}
+
+/* Enters T, which has just been given its tid, into the tid
+   table. */
+static void
+tid_table_insert (struct thread *t) 
+{
+  enum intr_level old_level;
+
+  ASSERT (t->tid != TID_ERROR);
 
-    return NULL;  // 해당 tid를 가진 스레드가 없을 경우 NULL 반환
+  old_level = intr_disable ();
+  list_push_back (&tid_table[(unsigned) t->tid % TID_BUCKETS], &t->tid_elem);
+  intr_set_level (old_level);
 }
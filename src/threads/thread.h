@@ -3,9 +3,11 @@
 
 #include <debug.h>
 #include <list.h>
+#include <rbtree.h>
 #include <stdint.h>
 #include "synch.h"
 #include <hash.h>
+#include "devices/timerq.h"
 
 /* States in a thread's life cycle. */
 enum thread_status
@@ -16,6 +18,48 @@ enum thread_status
     THREAD_DYING        /* About to be destroyed. */
   };
 
+/* What a blocked thread is waiting for, for scheduler
+   statistics. */
+enum thread_wait
+  {
+    WAIT_OTHER,         /* Not classified. */
+    WAIT_SLEEP,         /* timer_sleep(). */
+    WAIT_SEMA,          /* sema_down() on a plain semaphore. */
+    WAIT_LOCK,          /* lock_acquire(). */
+    WAIT_COND,          /* cond_wait(). */
+    WAIT_IO,            /* Device input or output queue. */
+    WAIT_CNT            /* Number of kinds. */
+  };
+
+/* Scheduler statistics of a thread.  Times are in TSC cycles. */
+struct sched_stats
+  {
+    uint64_t stamp;                 /* When the thread last changed state. */
+    uint64_t run_delay;             /* Total time ready but not running. */
+    uint64_t max_run_delay;         /* Longest single stretch ready. */
+    uint64_t wait_time[WAIT_CNT];   /* Total time blocked, by kind. */
+    uint32_t nvcsw;                 /* Switches away by blocking. */
+    uint32_t nivcsw;                /* Switches away while still ready. */
+    bool woken;                     /* Ready because of thread_unblock()? */
+  };
+
+/* Earliest-deadline-first scheduling parameters.  A thread with
+   a nonzero period is in the EDF class, which is scheduled ahead
+   of every priority, earliest deadline first.  Its CPU time is
+   limited to `runtime' per `period' by a constant bandwidth
+   server: once the budget is used up, the thread is throttled
+   until its deadline.  Times are in timer ticks. */
+struct edf_params
+  {
+    int64_t period;                 /* Period, or 0 if not EDF. */
+    int64_t runtime;                /* CPU time allowed per period. */
+    int64_t deadline;               /* Current absolute deadline. */
+    int64_t budget;                 /* CPU time left until deadline. */
+    bool throttled;                 /* Out of budget until deadline? */
+    struct heap_elem elem;          /* Element in run queue's EDF heap. */
+    struct timer_event replenish;   /* Ends throttling at deadline. */
+  };
+
 /* Thread identifier type.
    You can redefine this to whatever type you like. */
 typedef int tid_t;
@@ -26,6 +70,11 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Thread nice values. */
+#define NICE_MIN -20                    /* Most favored. */
+#define NICE_DEFAULT 0                  /* Default nice value. */
+#define NICE_MAX 20                     /* Least favored. */
+
 /* A kernel thread or user process.
 
    Each thread structure is stored in its own 4 kB page.  The
@@ -92,18 +141,32 @@ struct thread
    char name[16];                      /* Name (for debugging purposes). */
    uint8_t *stack;                     /* Saved stack pointer. */
    int64_t wake_up_time;               /* wakeup time */
+   struct timer_event sleep_timer;     /* Wakes the thread from thread_sleep(). */
    int priority;                       /* Priority. */
    int original_priority;              /* original priority */
 
    int nice; 
    int recent_cpu;
+   int recent_cpu_epoch;               /* mlfqs second recent_cpu is current as of */
 
    struct list_elem allelem;           /* List element for all threads list. */
+   struct list_elem tid_elem;          /* List element in tid table. */
    struct list_elem elem;              /* List element. */
 
+   enum thread_wait wait;              /* What we block on next. */
+   struct sched_stats sched;           /* Scheduler statistics. */
+   uint64_t user_time;                 /* TSC cycles run in user mode. */
+   uint64_t system_time;               /* TSC cycles run in the kernel. */
+   uint64_t cpu_stamp;                 /* Start of CPU time not yet charged. */
+   struct edf_params edf;              /* EDF parameters. */
+   int64_t vruntime;                   /* CFS: weighted CPU time. */
+   struct rb_elem cfs_elem;            /* CFS: element in run queue. */
+
    struct lock *lock_wait;          /* lock trying to acquire */
-   struct list donation_list;         /* donation list */
-   struct list_elem donation_elem;   /* donation list element */
+   struct heap_elem waiter_elem;    /* Element in lock_wait's waiters. */
+   struct heap held_locks;          /* Held locks, by top waiter. */
+   struct waitq_elem waitq_elem;    /* Element in a semaphore's waiters. */
+   struct waitq_elem *wait_entry;   /* Entry to re-key on donation. */
 
 
 #ifdef USERPROG
@@ -112,8 +175,10 @@ struct thread
     struct pcb *pcb; /*PCB*/
 
    struct thread *parent_process;
+   tid_t parent_tid;               /* Tid of parent_process. */
    struct list children;           // List of child processes
    struct list_elem child_elem;    // Element for child list in the parent process
+   bool reaped;                    /* Parent is done with us; see thread_reap(). */
 #endif
 
    struct hash spt;
@@ -129,11 +194,26 @@ struct thread
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use the completely fair scheduler, which shares the
+   CPU among threads in proportion to weights derived from their
+   nice values and ignores priorities.
+   Controlled by kernel command-line option "-cfs". */
+extern bool thread_cfs;
+
+/* If true (default), the pages of dead threads are kept for
+   reuse by thread_create(). */
+extern bool thread_cache_enabled;
+
 void thread_init (void);
 void thread_start (void);
 
 void thread_tick (void);
 void thread_print_stats (void);
+void thread_reap (struct thread *);
+void thread_print_sched_stats (void);
+void thread_account (bool user);
+void thread_get_cpu_time (struct thread *, uint64_t *user_ns,
+                          uint64_t *system_ns);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
@@ -153,6 +233,7 @@ typedef void thread_action_func (struct thread *t, void *aux);
 void thread_foreach (thread_action_func *, void *);
 
 int thread_get_priority (void);
+bool thread_set_deadline (int64_t period, int64_t runtime);
 void thread_set_priority (int);
 
 int thread_get_nice (void);
@@ -161,24 +242,23 @@ int thread_get_recent_cpu (void);
 int thread_get_load_avg (void);
 
 /* Custom function in Lab1*/
-void thread_wakeup(int64_t ticks);
 void thread_sleep(int64_t ticks);
-bool compare_wakeup_ticks(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 bool compare_priority_desc(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 bool compare_ticks_asec(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 void thread_preempt(void);
-void thread_donate_priority(struct thread *holder, int depth);
-void thread_donate_priority_test(void);
-void thread_remove_donation_elem(struct thread *releasing_thread, struct lock *lock);
-void thread_reflect_donation_list(void);
+void thread_update_priority(struct thread *t, int priority);
+void thread_donate_priority (struct thread *);
+bool thread_refresh_priority (struct thread *);
 
 void increase_recent_cpu(void);
 void MLFQS_priority_update(void);
 void calc_recent_cpu(struct thread *t);
+void calc_decay(void);
 void calc_load_avg(void);
 void recent_cpu_update(void);
 
-struct thread* get_thread_by_tid(tid_t tid);
+struct thread *get_thread_by_tid (tid_t tid);
+struct thread *thread_find (tid_t tid);
 
 
 #endif /* threads/thread.h */
\ No newline at end of file
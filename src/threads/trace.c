@@ -0,0 +1,124 @@
+#include "threads/trace.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/tsc.h"
+#include "threads/vaddr.h"
+
+/* Size of the ring buffer, allocated the first time tracing
+   starts.  TRACE_RECORDS is a power of 2. */
+#define TRACE_PAGES 16
+#define TRACE_RECORDS (TRACE_PAGES * PGSIZE / sizeof (struct trace_record))
+
+/* Bit E is set if event E is enabled. */
+uint32_t trace_mask;
+
+static struct trace_record *trace_buf;
+static uint32_t trace_head;     /* Sequence number of next record. */
+static uint64_t start_tsc;      /* TSC when tracing started. */
+static int64_t start_ticks;     /* Timer ticks when tracing started. */
+
+/* Starts tracing the events in MASK, if any, during boot.  Must
+   be called after the page allocator is initialized. */
+void
+trace_init (uint32_t mask)
+{
+  if (mask != 0 && !trace_start (mask))
+    printf ("trace: could not allocate trace buffer\n");
+}
+
+/* Clears the trace buffer and starts tracing the events in MASK.
+   Returns false if the buffer cannot be allocated. */
+bool
+trace_start (uint32_t mask)
+{
+  enum intr_level old_level;
+
+  if (trace_buf == NULL)
+    {
+      trace_buf = palloc_get_multiple (PAL_ZERO, TRACE_PAGES);
+      if (trace_buf == NULL)
+        return false;
+    }
+
+  old_level = intr_disable ();
+  trace_head = 0;
+  start_tsc = rdtsc ();
+  start_ticks = timer_ticks ();
+  trace_mask = mask;
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Stops tracing.  The buffer is kept for trace_dump(). */
+void
+trace_stop (void)
+{
+  trace_mask = 0;
+}
+
+/* Appends a record of EVENT with arguments A0, A1 and A2 to the
+   trace.  Use the TRACE macro instead of calling this directly.
+
+   The record's sequence number is written last, so that a
+   record that was still being written when the trace was dumped
+   can be told apart by the decoder. */
+void
+trace_record (enum trace_event event, uint32_t a0, uint32_t a1, uint32_t a2)
+{
+  uint32_t seq = __atomic_fetch_add (&trace_head, 1, __ATOMIC_RELAXED);
+  struct trace_record *r = &trace_buf[seq % TRACE_RECORDS];
+  const struct thread *t;
+  uint32_t *esp;
+
+  /* thread_current() insists that the thread be running, which
+     it is not in the middle of a switch, so find it by its
+     stack pointer instead. */
+  asm ("mov %%esp, %0" : "=g" (esp));
+  t = pg_round_down (esp);
+
+  r->tsc = rdtsc ();
+  r->tid = t->tid;
+  r->event = event;
+  r->arg[0] = a0;
+  r->arg[1] = a1;
+  r->arg[2] = a2;
+  __atomic_store_n (&r->seq, seq, __ATOMIC_RELEASE);
+}
+
+/* Writes the trace buffer, oldest record first, to the console.
+   Tracing pauses while the buffer is written. */
+void
+trace_dump (void)
+{
+  uint32_t mask = trace_mask;
+  uint64_t cycles_per_tick = 0;
+  uint32_t first, head, seq;
+  int64_t ticks;
+
+  if (trace_buf == NULL)
+    return;
+
+  trace_mask = 0;
+  head = trace_head;
+  first = head > TRACE_RECORDS ? head - TRACE_RECORDS : 0;
+  ticks = timer_elapsed (start_ticks);
+  if (ticks > 0)
+    cycles_per_tick = (rdtsc () - start_tsc) / ticks;
+
+  printf ("Trace: begin %"PRIu32" records, %"PRIu32" overwritten, "
+          "%"PRIu64" cycles per tick\n", head - first, first, cycles_per_tick);
+  for (seq = first; seq != head; seq++)
+    {
+      const uint32_t *w = (const uint32_t *) &trace_buf[seq % TRACE_RECORDS];
+      printf ("Trace: %08"PRIx32" %08"PRIx32" %08"PRIx32" %08"PRIx32
+              " %08"PRIx32" %08"PRIx32" %08"PRIx32" %08"PRIx32"\n",
+              w[0], w[1], w[2], w[3], w[4], w[5], w[6], w[7]);
+    }
+  printf ("Trace: end\n");
+  trace_mask = mask;
+}
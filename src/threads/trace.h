@@ -0,0 +1,68 @@
+#ifndef THREADS_TRACE_H
+#define THREADS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Kernel event tracing.
+
+   A tracepoint records an event, with the TSC, the running
+   thread and up to three arguments, in a ring buffer.  Records
+   are claimed with an atomic increment, so tracepoints take no
+   lock and may be hit from interrupt handlers; once the buffer
+   is full, the oldest records are overwritten.
+
+   Each event can be enabled separately through trace_mask.  A
+   disabled tracepoint costs a load and a predictable branch.
+
+   trace_dump() writes the buffer to the console as lines of hex
+   words, which utils/tracedump decodes into a timeline.  Keep
+   the events below in sync with the names there. */
+
+/* Traced events.  The arguments are listed for each. */
+enum trace_event
+  {
+    TRACE_SWITCH,               /* Next tid, old thread's status. */
+    TRACE_WAKEUP,               /* Woken tid, what it waited for. */
+    TRACE_PAGE_FAULT,           /* Fault address, error code, eip. */
+    TRACE_EVICT,                /* palloc flags. */
+    TRACE_SWAP_IN,              /* Swap slot, kernel address. */
+    TRACE_SWAP_OUT,             /* Swap slot, kernel address. */
+    TRACE_BLOCK_READ,           /* Sector, block type. */
+    TRACE_BLOCK_WRITE,          /* Sector, block type. */
+    TRACE_SYSCALL_ENTER,        /* Syscall number, user stack pointer. */
+    TRACE_SYSCALL_EXIT,         /* Syscall number, return value. */
+    TRACE_EVENT_CNT             /* Number of events. */
+  };
+
+/* A trace record, as dumped.  32 bytes. */
+struct trace_record
+  {
+    uint64_t tsc;               /* Time-stamp counter. */
+    uint32_t seq;               /* Position in the trace. */
+    int32_t tid;                /* Running thread. */
+    uint32_t event;             /* enum trace_event. */
+    uint32_t arg[3];            /* Event arguments. */
+  };
+
+/* Bit E is set if event E is enabled. */
+extern uint32_t trace_mask;
+
+/* Records EVENT with arguments A0, A1 and A2 if EVENT is
+   enabled. */
+#define TRACE(EVENT, A0, A1, A2)                                        \
+        do                                                              \
+          {                                                             \
+            if (__builtin_expect ((trace_mask >> (EVENT)) & 1, 0))      \
+              trace_record ((EVENT), (uint32_t) (A0), (uint32_t) (A1),  \
+                            (uint32_t) (A2));                           \
+          }                                                             \
+        while (0)
+
+void trace_init (uint32_t mask);
+bool trace_start (uint32_t mask);
+void trace_stop (void);
+void trace_record (enum trace_event, uint32_t, uint32_t, uint32_t);
+void trace_dump (void);
+
+#endif /* threads/trace.h */
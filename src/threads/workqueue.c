@@ -0,0 +1,258 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+
+/* General-purpose queue. */
+struct workqueue *system_wq;
+
+/* Number of workers in system_wq. */
+#define SYSTEM_WQ_WORKERS 2
+
+/* A thread waiting in flush_work(). */
+struct flusher
+  {
+    struct list_elem elem;      /* Element in workqueue's flushers. */
+    struct thread *thread;      /* The waiting thread. */
+  };
+
+static void worker_loop (void *worker_);
+static void insert_work (struct workqueue *, struct work *);
+static bool work_busy (const struct work *);
+static void delayed_work_timer (void *dwork_);
+
+/* Creates system_wq.  Must be called after thread_start(). */
+void
+workqueue_init (void) 
+{
+  system_wq = workqueue_create ("kworker", PRI_DEFAULT, SYSTEM_WQ_WORKERS);
+  if (system_wq == NULL)
+    PANIC ("could not create system workqueue");
+}
+
+/* Creates and returns a workqueue named NAME served by
+   WORKER_CNT worker threads that run at PRIORITY.  Returns a
+   null pointer if memory or threads cannot be allocated.
+   Workqueues are never destroyed. */
+struct workqueue *
+workqueue_create (const char *name, int priority, int worker_cnt) 
+{
+  struct workqueue *wq;
+  int i;
+
+  ASSERT (name != NULL);
+  ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+  ASSERT (worker_cnt > 0 && worker_cnt <= WORKQUEUE_MAX_WORKERS);
+
+  wq = malloc (sizeof *wq);
+  if (wq == NULL)
+    return NULL;
+
+  wq->name = name;
+  wq->priority = priority;
+  list_init (&wq->items);
+  sema_init (&wq->ready, 0);
+  list_init (&wq->flushers);
+  wq->worker_cnt = 0;
+  for (i = 0; i < worker_cnt; i++) 
+    {
+      struct worker *w = &wq->workers[i];
+
+      w->wq = wq;
+      w->current = NULL;
+      if (thread_create (name, priority, worker_loop, w) == TID_ERROR)
+        break;
+      wq->worker_cnt++;
+    }
+
+  /* Workers already started may be blocked on WQ, so WQ cannot be
+     freed, but it is useless without any. */
+  return wq->worker_cnt > 0 ? wq : NULL;
+}
+
+/* Initializes WORK to call FUNC. */
+void
+work_init (struct work *work, work_func *func) 
+{
+  ASSERT (work != NULL);
+  ASSERT (func != NULL);
+
+  work->func = func;
+  work->wq = NULL;
+  work->pending = false;
+}
+
+/* Initializes DWORK to call FUNC. */
+void
+delayed_work_init (struct delayed_work *dwork, work_func *func) 
+{
+  ASSERT (dwork != NULL);
+
+  work_init (&dwork->work, func);
+  timer_event_init (&dwork->timer, delayed_work_timer, dwork);
+}
+
+/* Queues WORK on WQ, unless it is already pending.  Returns true
+   if WORK was queued, false if it was already pending.
+
+   This function may be called from an interrupt handler. */
+bool
+queue_work (struct workqueue *wq, struct work *work) 
+{
+  enum intr_level old_level;
+
+  ASSERT (wq != NULL);
+  ASSERT (work != NULL);
+
+  old_level = intr_disable ();
+  if (work->pending) 
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  work->pending = true;
+  insert_work (wq, work);
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Queues DWORK on WQ once TICKS timer ticks have passed, unless
+   it is already pending.  Returns true if DWORK was queued,
+   false if it was already pending.
+
+   This function may be called from an interrupt handler. */
+bool
+queue_delayed_work (struct workqueue *wq, struct delayed_work *dwork,
+                    int64_t ticks) 
+{
+  enum intr_level old_level;
+
+  ASSERT (wq != NULL);
+  ASSERT (dwork != NULL);
+
+  old_level = intr_disable ();
+  if (dwork->work.pending) 
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  dwork->work.pending = true;
+  if (ticks <= 0)
+    insert_work (wq, &dwork->work);
+  else 
+    {
+      dwork->work.wq = wq;
+      timer_event_arm (&dwork->timer, timer_ticks () + ticks);
+    }
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Waits until WORK is neither pending nor running.  Work queued
+   again after this function starts waiting may or may not be
+   waited for.  WORK must not be freed while this function may be
+   waiting for it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler, nor by WORK's own function. */
+void
+flush_work (struct work *work) 
+{
+  enum intr_level old_level;
+
+  ASSERT (work != NULL);
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  while (work_busy (work)) 
+    {
+      struct flusher f;
+
+      f.thread = thread_current ();
+      list_push_back (&work->wq->flushers, &f.elem);
+      thread_block ();
+    }
+  intr_set_level (old_level);
+}
+
+/* Appends WORK, already marked pending, to WQ and wakes up a
+   worker.  Interrupts must be off. */
+static void
+insert_work (struct workqueue *wq, struct work *work) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  work->wq = wq;
+  list_push_back (&wq->items, &work->elem);
+  sema_up (&wq->ready);
+}
+
+/* Returns true if WORK is pending or being run by a worker.
+   Interrupts must be off. */
+static bool
+work_busy (const struct work *work) 
+{
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (work->pending)
+    return true;
+  if (work->wq == NULL)
+    return false;
+  for (i = 0; i < work->wq->worker_cnt; i++)
+    if (work->wq->workers[i].current == work)
+      return true;
+  return false;
+}
+
+/* Worker thread.  Runs WORKER_'s queue's work items one at a
+   time, forever. */
+static void
+worker_loop (void *worker_) 
+{
+  struct worker *w = worker_;
+  struct workqueue *wq = w->wq;
+
+  for (;;) 
+    {
+      enum intr_level old_level;
+      struct work *work;
+
+      sema_down (&wq->ready);
+
+      old_level = intr_disable ();
+      ASSERT (!list_empty (&wq->items));
+      work = list_entry (list_pop_front (&wq->items), struct work, elem);
+      work->pending = false;
+      w->current = work;
+      intr_set_level (old_level);
+
+      /* WORK may requeue or even free itself, so it is not
+         touched again after this call. */
+      work->func (work);
+
+      /* Let everyone waiting for some item of ours check
+         whether theirs is done. */
+      old_level = intr_disable ();
+      w->current = NULL;
+      while (!list_empty (&wq->flushers)) 
+        {
+          struct list_elem *e = list_pop_front (&wq->flushers);
+          thread_unblock (list_entry (e, struct flusher, elem)->thread);
+        }
+      intr_set_level (old_level);
+    }
+}
+
+/* Timer callback for a delayed work item DWORK_: queues the work
+   on the queue recorded by queue_delayed_work(). */
+static void
+delayed_work_timer (void *dwork_) 
+{
+  struct delayed_work *dwork = dwork_;
+
+  insert_work (dwork->work.wq, &dwork->work);
+}
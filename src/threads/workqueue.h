@@ -0,0 +1,83 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/timerq.h"
+#include "threads/synch.h"
+
+/* Deferred work.
+
+   A work item is a function to be called later by one of the
+   kernel worker threads of a workqueue, instead of by the thread
+   or interrupt handler that has the work to do.  Each workqueue
+   has its own pool of workers, all running at the queue's
+   priority, so that background work such as write-back can run
+   below interactive threads and urgent bottom halves above
+   them.
+
+   queue_work() and queue_delayed_work() may be called from
+   interrupt handlers.  A work item that is already pending is
+   not queued a second time.  Work functions run in a kernel
+   thread and may sleep, and may requeue their own work item. */
+
+struct work;
+
+/* Performs WORK. */
+typedef void work_func (struct work *work);
+
+/* A work item. */
+struct work
+  {
+    struct list_elem elem;      /* Element in workqueue's list. */
+    work_func *func;            /* Function to call. */
+    struct workqueue *wq;       /* Queue last queued on, or null. */
+    bool pending;               /* Queued and not yet started? */
+  };
+
+/* A work item that is queued only once a number of timer ticks
+   has passed. */
+struct delayed_work
+  {
+    struct work work;           /* The work itself. */
+    struct timer_event timer;   /* Queues `work' when it expires. */
+  };
+
+/* Maximum number of worker threads per workqueue. */
+#define WORKQUEUE_MAX_WORKERS 8
+
+/* A worker thread. */
+struct worker
+  {
+    struct workqueue *wq;       /* Queue we take work from. */
+    struct work *current;       /* Work item being run, or null. */
+  };
+
+/* A workqueue. */
+struct workqueue
+  {
+    const char *name;           /* Name, also of the workers. */
+    int priority;               /* Priority of the workers. */
+    struct list items;          /* Pending work items. */
+    struct semaphore ready;     /* Upped once per pending item. */
+    struct list flushers;       /* Threads waiting in flush_work(). */
+    int worker_cnt;             /* Number of workers. */
+    struct worker workers[WORKQUEUE_MAX_WORKERS];
+  };
+
+/* General-purpose queue, running at PRI_DEFAULT. */
+extern struct workqueue *system_wq;
+
+void workqueue_init (void);
+struct workqueue *workqueue_create (const char *name, int priority,
+                                    int worker_cnt);
+
+void work_init (struct work *, work_func *);
+void delayed_work_init (struct delayed_work *, work_func *);
+bool queue_work (struct workqueue *, struct work *);
+bool queue_delayed_work (struct workqueue *, struct delayed_work *,
+                         int64_t ticks);
+void flush_work (struct work *);
+
+#endif /* threads/workqueue.h */
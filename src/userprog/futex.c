@@ -0,0 +1,57 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <stdint.h>
+#include "userprog/syscall.h"
+#include "vm/frame.h"
+#include "vm/page.h"
+
+/* Pintos processes share no memory, so a futex word belongs to
+   one process, and only a thread of that process could wake a
+   thread waiting on it.  Each process has a single thread, so a
+   futex_wait() that went to sleep would never be woken, and the
+   process would hang along with any parent waiting for it.
+   futex_wait() therefore reports the deadlock instead of
+   sleeping, and futex_wake() never has anyone to wake. */
+
+static struct spt_entry *futex_page (int *uaddr);
+
+/* Returns 0 if *UADDR differs from VAL.  If *UADDR equals VAL,
+   the caller would have to sleep until another thread of its
+   process called futex_wake() on UADDR, but there is no such
+   thread, so returns -1 at once.  Terminates the process if
+   UADDR is not a valid, aligned user address. */
+int
+futex_wait (int *uaddr, int val)
+{
+  struct spt_entry *page = futex_page (uaddr);
+  int word;
+
+  /* Pin the page so that the read faults it in, if necessary,
+     and cannot lose it to eviction halfway. */
+  frame_pin (page);
+  word = *uaddr;
+  frame_unpin (page);
+  return word != val ? 0 : -1;
+}
+
+/* Wakes up to CNT threads waiting on UADDR and returns the
+   number woken, which is always 0 because futex_wait() never
+   sleeps.  Terminates the process if UADDR is not a valid,
+   aligned user address. */
+int
+futex_wake (int *uaddr, int cnt UNUSED)
+{
+  futex_page (uaddr);
+  return 0;
+}
+
+/* Returns the supplemental page table entry for the page that
+   holds UADDR in the running process.  Terminates the process
+   if UADDR is not a valid, aligned user address. */
+static struct spt_entry *
+futex_page (int *uaddr)
+{
+  if ((uintptr_t) uaddr % sizeof *uaddr != 0)
+    sys_exit (-1);
+  return check_address (uaddr);
+}
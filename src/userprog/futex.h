@@ -0,0 +1,18 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+/* Futexes: wait queues for user programs, keyed by the address
+   of a word in user memory.
+
+   A user program keeps its lock or condition state in an int
+   that it updates with atomic instructions, and calls into the
+   kernel only when it has to wait or to wake waiters, so that an
+   uncontended lock needs no system call.  A process has a single
+   thread, so no one could ever end a wait: futex_wait() returns
+   -1 instead of sleeping when the word holds the value that
+   would make the caller wait. */
+
+int futex_wait (int *uaddr, int val);
+int futex_wake (int *uaddr, int cnt);
+
+#endif /* userprog/futex.h */
@@ -236,6 +236,7 @@ start_process (void *file_name_)
      arguments on the stack in the form of a `struct intr_frame',
      we just point the stack pointer (%esp) to our stack frame
      and jump to it. */
+  thread_account (false);
   asm volatile ("movl %0, %%esp; jmp intr_exit" : : "g" (&if_) : "memory");
   NOT_REACHED ();
 }
@@ -276,7 +277,7 @@ process_wait (tid_t child_tid)
   list_remove(&child->child_elem);
   palloc_free_page(child->pcb);
   child->pcb = NULL;
-  palloc_free_page (child);
+  thread_reap (child);
 
   return exit_code;
 }
@@ -360,47 +361,37 @@ process_activate (void)
 }
 
 /* 자식 프로세스 디스크립터를 검색하는 함수 (get_child_process)
-현재 프로세스의 자식 리스트를 검색하여 해당 pid에 맞는 프로세스 디스크립터를 반환
+tid 테이블에서 pid에 맞는 프로세스 디스크립터를 찾아, 현재 프로세스의 자식이면 반환
 struct thread *thread_current(void) : 현재 프로세스의 디스크립터 반환
 pid를 갖는 프로세스 디스크립터가 존재하지 않을 경우 NULL 반환 */
 struct thread* 
 get_child_process(tid_t child_tid)
 {
-  struct thread *t = thread_current();
-  struct thread *child;
-  struct list *child_list = &(t->children);
-
-  for (struct list_elem *e = list_begin(child_list); e != list_end(child_list); e = list_next(e))
-  {
-    child = list_entry(e, struct thread, child_elem);
+  struct thread *child = thread_find (child_tid);
 
-    if (child->tid == child_tid)
-      return child;
-  }
+  /* The tid table holds every thread, so check that CHILD is
+     ours.  Tids are never reused, so comparing the parent's tid
+     is safe even if our parent pointer is stale.  A reaped child
+     stays in the table until its last switch. */
+  if (child == NULL || child->parent_tid != thread_tid () || child->reaped)
+    return NULL;
 
-  return NULL;
+  return child;
 }
 
 /* 프로세스 디스크립터를 자식 리스트에서 제거 후 메모리 해제 */
 void 
 remove_child_process(tid_t child_tid)
 {
-  struct thread *t = thread_current();
-  struct thread *child; 
-  struct list *child_list = &(t->children);
+  struct thread *child = get_child_process (child_tid);
 
-  for (struct list_elem *e = list_begin(child_list); e != list_end(child_list); e = list_next(e))
-  {
-    child = list_entry(e, struct thread, child_elem);
-    if (child->tid == child_tid)
-    {
-      list_remove(e);
-      palloc_free_page(child->pcb);
-      child->pcb = NULL;
-      palloc_free_page (child);
-      return;
-    }
-  }
+  if (child == NULL)
+    return;
+
+  list_remove(&child->child_elem);
+  palloc_free_page(child->pcb);
+  child->pcb = NULL;
+  thread_reap (child);
 }
 
 int
@@ -479,6 +470,10 @@ bool handle_mm_fault(struct spt_entry *_spte)
 {
   struct frame *f;
   uint8_t *kpage;
+
+  /* If the page is being evicted, wait until its type and swap
+     slot say where its contents went. */
+  frame_wait(_spte);
   
   switch (_spte->type)
   {
@@ -498,11 +493,20 @@ bool handle_mm_fault(struct spt_entry *_spte)
       f->spte->kpage = kpage; 
       return true;
     case VM_ANON:
-    f = falloc(PAL_USER);
-    if (f == NULL) return false; 
-    f->spte = _spte;
-    kpage = f->kaddr;
-    swap_in(_spte, kpage);
+      f = falloc(PAL_USER);
+      if (f == NULL) return false; 
+      kpage = f->kaddr;
+      swap_in(_spte, kpage);
+      if (!install_page(_spte->vaddr, kpage, _spte->writable))
+      {
+          ffree(kpage);
+          return false;
+      }
+
+      _spte->is_loaded = true;
+      _spte->kpage = kpage;
+      f->spte = _spte;
+      return true;
     default: 
       return false;
   }
@@ -523,7 +527,7 @@ do_unmap(struct mmap_file *mmap_file)
   {
     struct spt_entry *spte = list_entry(spte_e, struct spt_entry, mmap_elem);
     
-    if(pagedir_is_dirty(&thread_current()->pagedir, spte->vaddr))
+    if(pagedir_is_dirty(thread_current()->pagedir, spte->vaddr))
     {
       file_write_at(spte->file, spte->vaddr, spte->read_bytes, spte->offset);
     }
@@ -627,18 +631,18 @@ load (const char *file_name, void (**eip) (void), void **esp)
   process_activate ();
 
   /* Open executable file. */
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_write(&filesys_lock);
   file = filesys_open (file_name);
   if (file == NULL) 
   {
     printf ("load: %s: open failed\n", file_name);
-    lock_release(&filesys_lock);
+    rwlock_release_write(&filesys_lock);
     goto done; 
   }
 
   t->pcb->run_file = file;
   file_deny_write(file);
-  lock_release(&filesys_lock);
+  rwlock_release_write(&filesys_lock);
 
   /* Read and verify executable header. */
   if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
@@ -808,7 +812,7 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
       /* Instead of loading file, just setup spte-JYL*/
       //init_spte_file (&thread_current ()->spt, upage, file, ofs, page_read_bytes, page_zero_bytes, writable);
 
-      struct spt_entry *spte = (struct spt_entry *)malloc(sizeof(struct spt_entry));
+      struct spt_entry *spte = alloc_spte();
       
       memset(spte, 0, sizeof(struct spt_entry));
       spte->type = VM_BIN;
@@ -844,7 +848,7 @@ setup_stack (void **esp)
   success = install_page(upage, kpage, true);
   if (success)
   {
-    f->spte = (struct spt_entry *)malloc(sizeof(struct spt_entry));
+    f->spte = alloc_spte();
     
     if (f->spte == NULL)
     {
@@ -1,15 +1,22 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
+#include <string.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
+#include "threads/profile.h"
+#include "threads/trace.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#include "userprog/futex.h"
 #include "process.h"
 #include "filesys/filesys.h"
 #include "filesys/file.h"
+#include "filesys/inode.h"
 
 static void syscall_handler (struct intr_frame *);
 
+struct rwlock filesys_lock;
+
 //added
 // struct semaphore rw_mutex, mutex;
 // int read_count;
@@ -94,7 +101,7 @@ void
 syscall_init (void) 
 {
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
-  lock_init(&filesys_lock);
+  rwlock_init(&filesys_lock);
 }
 
 static void
@@ -106,6 +113,8 @@ syscall_handler (struct intr_frame *f)
   int arg[3];
   int syscall_number = *(int *)(f->esp);
 
+  TRACE (TRACE_SYSCALL_ENTER, syscall_number, f->esp, 0);
+
   //printf("syscall_handler: syscall_number = %d\n", syscall_number);
 
   switch (syscall_number)
@@ -190,7 +199,60 @@ syscall_handler (struct intr_frame *f)
       get_argument(f->esp, arg, 1);
       sys_munmap((int) arg[0]);
       break;    
+
+    case SYS_SCHEDSTAT:
+      thread_print_sched_stats ();
+      break;
+
+    case SYS_LOCKSTAT:
+      lockstat_print (LOCKSTAT_TOP);
+      break;
+
+    case SYS_SET_DEADLINE:
+      get_argument (f->esp, arg, 2);
+      f->eax = thread_set_deadline ((int) arg[0], (int) arg[1]);
+      break;
+
+    case SYS_PROFILE:
+      get_argument (f->esp, arg, 1);
+      if ((int) arg[0] > 0)
+        profile_start (arg[0]);
+      else
+        {
+          profile_stop ();
+          profile_print ();
+        }
+      break;
+
+    case SYS_TRACE:
+      get_argument (f->esp, arg, 1);
+      if (arg[0] != 0)
+        f->eax = trace_start (arg[0]);
+      else
+        {
+          trace_stop ();
+          trace_dump ();
+          f->eax = true;
+        }
+      break;
+
+    case SYS_GETRUSAGE:
+      get_argument (f->esp, arg, 1);
+      f->eax = sys_getrusage ((struct rusage *) arg[0]);
+      break;
+
+    case SYS_FUTEX_WAIT:
+      get_argument (f->esp, arg, 2);
+      f->eax = futex_wait ((int *) arg[0], arg[1]);
+      break;
+
+    case SYS_FUTEX_WAKE:
+      get_argument (f->esp, arg, 2);
+      f->eax = futex_wake ((int *) arg[0], arg[1]);
+      break;
   }
+
+  TRACE (TRACE_SYSCALL_EXIT, syscall_number, f->eax, 0);
 }
 
 void 
@@ -226,29 +288,33 @@ sys_wait (tid_t pid)
 bool 
 sys_create (const char *file, unsigned initial_size)
 {
+  rwlock_acquire_write(&filesys_lock);
   bool retval = filesys_create (file, initial_size);
+  rwlock_release_write(&filesys_lock);
   return retval;
 }
 
 bool 
 sys_remove (const char *file)
 {
-  return filesys_remove (file);
+  rwlock_acquire_write(&filesys_lock);
+  bool retval = filesys_remove (file);
+  rwlock_release_write(&filesys_lock);
+  return retval;
 }
 
 int 
 sys_open (const char *file)
 {
-  lock_acquire(&filesys_lock);
+  rwlock_acquire_write(&filesys_lock);
   
   struct file *_file;
-  struct thread *t = thread_current ();
   int fd = 0;
 
   _file = filesys_open (file);
   if (_file == NULL) 
   {
-    lock_release(&filesys_lock);
+    rwlock_release_write(&filesys_lock);
     return -1;
   }
     
@@ -256,41 +322,40 @@ sys_open (const char *file)
   if (fd == -1)
   {
     file_close(_file);
-    lock_release(&filesys_lock);
+    rwlock_release_write(&filesys_lock);
     return -1;
   }
 
   // t->pcb->run_file = _file;
   // file_deny_write(_file);
 
-  lock_release(&filesys_lock);
+  rwlock_release_write(&filesys_lock);
   return fd;
 }
 
+/* An open file's length, position and inode belong to the
+   calling process alone, so sys_filesize, sys_seek and sys_tell
+   need no file system lock. */
 int 
 sys_filesize (int fd)
 {
-  lock_acquire(&filesys_lock);
   struct file *file = process_get_file(fd);
 
   if (file == NULL)
-  {
-    lock_release(&filesys_lock);
     return -1;
-  }
 
-  lock_release(&filesys_lock);
   return file_length (file);
 }
 
 int 
 sys_read (int fd, void *buffer, unsigned size)
 {
-  lock_acquire(&filesys_lock);
   int read_bytes = -1; 
 
   if (fd == 0) // fd가 0이면, 키보드 입력 
   {
+    /* The keyboard is not part of the file system, so waiting
+       for input must not hold up anyone else's file access. */
     unsigned i; 
     for (i = 0; i < size; i++)
     {
@@ -302,23 +367,21 @@ sys_read (int fd, void *buffer, unsigned size)
   {
     struct file *f = process_get_file(fd);
     if (f == NULL)
-    {
-      lock_release(&filesys_lock);
       return -1; 
-    }
 
+    rwlock_acquire_read(&filesys_lock);
+    inode_read_lock(file_get_inode(f));
     read_bytes = file_read(f, buffer, size);
+    inode_read_unlock(file_get_inode(f));
+    rwlock_release_read(&filesys_lock);
   }
 
-  lock_release(&filesys_lock);
   return read_bytes;
 }
 
 int 
 sys_write (int fd, const void *buffer, unsigned size)
 {
-  lock_acquire(&filesys_lock);
-
   int written_bytes = -1;
 
   if (fd == 1)// fd가 1일 경우, 표준 출력으로 간주하여 화면에 출력
@@ -330,62 +393,46 @@ sys_write (int fd, const void *buffer, unsigned size)
   { 
     struct file *f = process_get_file(fd);
     if (f == NULL)
-    {
-      lock_release(&filesys_lock);
       return -1; 
-    }
+
+    rwlock_acquire_read(&filesys_lock);
+    inode_write_lock(file_get_inode(f));
     written_bytes = file_write(f, buffer, size);
+    inode_write_unlock(file_get_inode(f));
+    rwlock_release_read(&filesys_lock);
   }
 
-  lock_release(&filesys_lock);
   return written_bytes;
 }
 
 void 
 sys_seek (int fd, unsigned position)
 {
-  lock_acquire(&filesys_lock);
-
   struct file *f = process_get_file(fd);
   if (f != NULL)
     file_seek (f, position);
-
-  lock_release(&filesys_lock);
 }
 
 unsigned 
 sys_tell (int fd)
 {
-  lock_acquire(&filesys_lock);
-  
-  int f_pos = -1;
   struct file *f = process_get_file(fd);
   if (f == NULL)
-  { 
-    lock_release(&filesys_lock);
     return -1;
-  }
-  f_pos = file_tell(f);
-
-  lock_release(&filesys_lock);
 
-  return f_pos;
+  return file_tell(f);
 }
 
 void 
 sys_close (int fd)
 {
-  lock_acquire(&filesys_lock);
-
   struct file *f = process_get_file(fd);
   if (f == NULL)
-  {
-    lock_release(&filesys_lock);
     return;
-  }
-  process_close_file(fd);
 
-  lock_release(&filesys_lock);
+  rwlock_acquire_write(&filesys_lock);
+  process_close_file(fd);
+  rwlock_release_write(&filesys_lock);
 }
 
 /*fd: 프로세스의 가상 주소공간에 매핑할 파일
@@ -418,7 +465,9 @@ sys_mmap (int fd, void *addr)
   list_init (&mmap_file->spte_list);
   
   file = process_get_file(fd);
+  rwlock_acquire_write(&filesys_lock);
   file_copy = file_reopen(file); 
+  rwlock_release_write(&filesys_lock);
 
   mmap_file->file = file_copy;
   mmap_file->mapid = thread_current()->next_mapid++;
@@ -431,8 +480,9 @@ sys_mmap (int fd, void *addr)
   struct spt_entry *spte; 
   while (length > 0)
   {
-    spte = (struct spt_entry *) malloc(sizeof(struct spt_entry));
+    spte = alloc_spte();
 
+    memset(spte, 0, sizeof(struct spt_entry));
     spte->type = VM_FILE;
     spte->is_loaded = false;
     spte->writable = true;
@@ -485,4 +535,22 @@ sys_munmap(int mapping) // consider CLOSE_ALL
   }
 }
 
+/* Stores the CPU time and context switches of the calling
+   process in *USAGE.  The CPU time is measured with the TSC at
+   every switch between threads and between user mode and the
+   kernel, so it is not limited to whole timer ticks. */
+bool
+sys_getrusage (struct rusage *usage)
+{
+  struct thread *t = thread_current ();
+  struct rusage r;
+
+  check_valid_buffer (usage, sizeof *usage, true);
+  check_valid_buffer ((char *) (usage + 1) - 1, 1, true);
 
+  thread_get_cpu_time (t, &r.utime, &r.stime);
+  r.nvcsw = t->sched.nvcsw;
+  r.nivcsw = t->sched.nivcsw;
+  *usage = r;
+  return true;
+}
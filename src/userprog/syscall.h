@@ -4,6 +4,7 @@
 #include "threads/synch.h"
 #include "threads/thread.h"
 #include <list.h>
+#include <syscall-nr.h>
 #include "vm/page.h"
 
 /* System call initialization function */
@@ -25,6 +26,7 @@ unsigned sys_tell(int fd);
 void sys_close(int fd);
 int sys_mmap(int fd, void *addr);
 void sys_munmap(int mapping);
+bool sys_getrusage (struct rusage *usage);
 
 /* Helper functions */
 void get_argument(void *esp, int *arg, int count);
@@ -32,7 +34,11 @@ struct spt_entry *check_address (void *addr);
 void check_valid_buffer (void *buffer, unsigned size, bool to_write);
 void check_valid_string(const void *str);
 
-/* Lock for synchronizing file-related operations */
-struct lock filesys_lock;
+/* Lock for synchronizing file-related operations.  Operations
+   that change the set of files or open inodes (create, remove,
+   open, close) hold it for writing; operations on the data of an
+   already open file hold it for reading and lock the file's inode
+   themselves. */
+extern struct rwlock filesys_lock;
 
 #endif /* userprog/syscall.h */
\ No newline at end of file
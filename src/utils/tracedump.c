@@ -0,0 +1,205 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lib/syscall-nr.h"
+#include "../threads/trace.h"
+
+/* Decodes the kernel event traces written by trace_dump() into
+   a timeline. */
+
+static const char *event_names[TRACE_EVENT_CNT] =
+  {
+    [TRACE_SWITCH] = "switch",
+    [TRACE_WAKEUP] = "wakeup",
+    [TRACE_PAGE_FAULT] = "page-fault",
+    [TRACE_EVICT] = "evict",
+    [TRACE_SWAP_IN] = "swap-in",
+    [TRACE_SWAP_OUT] = "swap-out",
+    [TRACE_BLOCK_READ] = "block-read",
+    [TRACE_BLOCK_WRITE] = "block-write",
+    [TRACE_SYSCALL_ENTER] = "syscall",
+    [TRACE_SYSCALL_EXIT] = "syscall-exit",
+  };
+
+static const char *syscall_names[] =
+  {
+    [SYS_HALT] = "halt", [SYS_EXIT] = "exit", [SYS_EXEC] = "exec",
+    [SYS_WAIT] = "wait", [SYS_CREATE] = "create", [SYS_REMOVE] = "remove",
+    [SYS_OPEN] = "open", [SYS_FILESIZE] = "filesize", [SYS_READ] = "read",
+    [SYS_WRITE] = "write", [SYS_SEEK] = "seek", [SYS_TELL] = "tell",
+    [SYS_CLOSE] = "close", [SYS_MMAP] = "mmap", [SYS_MUNMAP] = "munmap",
+    [SYS_CHDIR] = "chdir", [SYS_MKDIR] = "mkdir", [SYS_READDIR] = "readdir",
+    [SYS_ISDIR] = "isdir", [SYS_INUMBER] = "inumber",
+    [SYS_SCHEDSTAT] = "schedstat", [SYS_LOCKSTAT] = "lockstat",
+    [SYS_SET_DEADLINE] = "set_deadline", [SYS_PROFILE] = "profile",
+    [SYS_TRACE] = "trace", [SYS_GETRUSAGE] = "getrusage",
+    [SYS_FUTEX_WAIT] = "futex_wait", [SYS_FUTEX_WAKE] = "futex_wake",
+  };
+
+/* Must match enum thread_status, enum thread_wait and enum
+   block_type in the kernel. */
+static const char *status_names[] = {"running", "ready", "blocked", "dying"};
+static const char *wait_names[] = {"other", "sleep", "sema", "lock", "cond",
+                                   "io"};
+static const char *block_names[] = {"kernel", "filesys", "scratch", "swap",
+                                    "raw", "foreign"};
+
+#define NAME(ARRAY, INDEX)                                              \
+        ((INDEX) < sizeof (ARRAY) / sizeof *(ARRAY) && (ARRAY)[INDEX]   \
+         ? (ARRAY)[INDEX] : "?")
+
+static void print_record (const struct trace_record *, uint64_t first_tsc,
+                          uint64_t prev_tsc, uint64_t cycles_per_tick);
+static void print_time (uint64_t cycles, uint64_t cycles_per_tick);
+
+int
+main (int argc, char *argv[])
+{
+  FILE *in = stdin;
+  char line[256];
+  uint64_t cycles_per_tick = 0;
+  uint64_t first_tsc = 0, prev_tsc = 0;
+  uint32_t seq = 0;
+  int in_trace = 0;
+  int bad_cnt = 0;
+
+  if (argc > 2 || (argc == 2 && !strcmp (argv[1], "--help")))
+    {
+      fprintf (stderr,
+               "tracedump: decodes kernel event traces into a timeline\n"
+               "usage: %s [OUTPUT]\n"
+               "  where OUTPUT is the console output of a run with\n"
+               "  tracing on, by default read from stdin.\n",
+               argv[0]);
+      return EXIT_FAILURE;
+    }
+  if (argc == 2)
+    {
+      in = fopen (argv[1], "r");
+      if (in == NULL)
+        {
+          fprintf (stderr, "%s: %s: %s\n", argv[0], argv[1], strerror (errno));
+          return EXIT_FAILURE;
+        }
+    }
+
+  while (fgets (line, sizeof line, in) != NULL)
+    {
+      const char *p = strstr (line, "Trace: ");
+      unsigned records, overwritten;
+      unsigned long long cpt;
+      uint32_t w[8];
+      struct trace_record r;
+
+      if (p == NULL)
+        continue;
+      p += strlen ("Trace: ");
+
+      if (sscanf (p, "begin %u records, %u overwritten, %llu cycles per tick",
+                  &records, &overwritten, &cpt) == 3)
+        {
+          printf ("%u records, %u overwritten before the first\n",
+                  records, overwritten);
+          printf ("%14s %14s %5s  %-12s %s\n",
+                  "time", "delta", "tid", "event", "details");
+          cycles_per_tick = cpt;
+          seq = overwritten;
+          in_trace = 1;
+          first_tsc = prev_tsc = 0;
+          continue;
+        }
+      if (!in_trace)
+        continue;
+      if (!strncmp (p, "end", 3))
+        {
+          in_trace = 0;
+          putchar ('\n');
+          continue;
+        }
+      if (sscanf (p, "%"SCNx32" %"SCNx32" %"SCNx32" %"SCNx32
+                  " %"SCNx32" %"SCNx32" %"SCNx32" %"SCNx32,
+                  &w[0], &w[1], &w[2], &w[3], &w[4], &w[5], &w[6], &w[7]) != 8)
+        continue;
+
+      memcpy (&r, w, sizeof r);
+      if (r.seq != seq++)
+        {
+          /* Still being written when the trace was dumped. */
+          bad_cnt++;
+          continue;
+        }
+      if (first_tsc == 0)
+        first_tsc = prev_tsc = r.tsc;
+      print_record (&r, first_tsc, prev_tsc, cycles_per_tick);
+      prev_tsc = r.tsc;
+    }
+
+  if (bad_cnt > 0)
+    fprintf (stderr, "%s: skipped %d incomplete records\n", argv[0], bad_cnt);
+  return EXIT_SUCCESS;
+}
+
+/* Prints R as a line of the timeline.  Times are relative to
+   FIRST_TSC, and deltas to PREV_TSC. */
+static void
+print_record (const struct trace_record *r, uint64_t first_tsc,
+              uint64_t prev_tsc, uint64_t cycles_per_tick)
+{
+  const uint32_t *a = r->arg;
+
+  print_time (r->tsc - first_tsc, cycles_per_tick);
+  putchar (' ');
+  print_time (r->tsc - prev_tsc, cycles_per_tick);
+  printf (" %5"PRId32"  %-12s ", r->tid, NAME (event_names, r->event));
+
+  switch (r->event)
+    {
+    case TRACE_SWITCH:
+      printf ("to %"PRIu32", leaving %s", a[0], NAME (status_names, a[1]));
+      break;
+    case TRACE_WAKEUP:
+      printf ("%"PRIu32", waited on %s", a[0], NAME (wait_names, a[1]));
+      break;
+    case TRACE_PAGE_FAULT:
+      printf ("0x%08"PRIx32" %s %s by %s, eip 0x%08"PRIx32, a[0],
+              a[1] & 1 ? "rights violation" : "not present",
+              a[1] & 2 ? "writing" : "reading",
+              a[1] & 4 ? "user" : "kernel", a[2]);
+      break;
+    case TRACE_EVICT:
+      printf ("flags 0x%"PRIx32, a[0]);
+      break;
+    case TRACE_SWAP_IN:
+    case TRACE_SWAP_OUT:
+      printf ("slot %"PRIu32", kaddr 0x%08"PRIx32, a[0], a[1]);
+      break;
+    case TRACE_BLOCK_READ:
+    case TRACE_BLOCK_WRITE:
+      printf ("%s sector %"PRIu32, NAME (block_names, a[1]), a[0]);
+      break;
+    case TRACE_SYSCALL_ENTER:
+      printf ("%s, esp 0x%08"PRIx32, NAME (syscall_names, a[0]), a[1]);
+      break;
+    case TRACE_SYSCALL_EXIT:
+      printf ("%s returned %"PRId32, NAME (syscall_names, a[0]),
+              (int32_t) a[1]);
+      break;
+    default:
+      printf ("0x%08"PRIx32" 0x%08"PRIx32" 0x%08"PRIx32, a[0], a[1], a[2]);
+      break;
+    }
+  putchar ('\n');
+}
+
+/* Prints CYCLES in milliseconds, with 10 ms per timer tick, or
+   in cycles if CYCLES_PER_TICK is unknown. */
+static void
+print_time (uint64_t cycles, uint64_t cycles_per_tick)
+{
+  if (cycles_per_tick != 0)
+    printf ("%11.4f ms", cycles * 10.0 / cycles_per_tick);
+  else
+    printf ("%14"PRIu64, cycles);
+}
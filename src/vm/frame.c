@@ -4,8 +4,10 @@
 #include "userprog/pagedir.h"
 #include "threads/thread.h"
 #include "threads/interrupt.h"
+#include "threads/trace.h"
 #include "threads/vaddr.h"
 #include "threads/palloc.h"
+#include "threads/slab.h"
 
 
 
@@ -14,12 +16,26 @@ static struct list lru_list;
 static struct lock lru_list_lock;
 static struct frame *lru_cursor;
 
+/* Signaled, with lru_list_lock, whenever reclaim_lent() finishes
+   evicting a page. */
+static struct condition evict_done;
+
+/* Cache of struct frame. */
+static struct kmem_cache *frame_cache;
+
+static bool reclaim_lent (void);
+static struct frame *pick_lent (void);
+static bool evict_lent (struct frame *);
+
 void
 lru_list_init (void) 
 {
     list_init(&lru_list);
     lock_init(&lru_list_lock);
     lru_cursor = NULL;
+    cond_init(&evict_done);
+    frame_cache = kmem_cache_create("frame", sizeof(struct frame), NULL);
+    palloc_set_reclaim(reclaim_lent);
 }
 
 
@@ -29,13 +45,13 @@ falloc(enum palloc_flags flags) {
     // Allocate frame from the user pool
     void *kpage = palloc_get_page(flags);
     while (kpage == NULL) {//free frame doesn’t exist
-        printf("page eviction called\n");
+        TRACE (TRACE_EVICT, flags, 0, 0);
         try_to_free_pages(flags);//try evict
         kpage = palloc_get_page(flags);
 	}
 
     // Create new frame structure
-    struct frame *f = malloc(sizeof(struct frame));
+    struct frame *f = kmem_cache_alloc(frame_cache);
     if (f == NULL) {
         palloc_free_page(kpage);
         return NULL;
@@ -71,7 +87,7 @@ ffree(void *kpage) {
 
             // Free the physical memory and the frame structure
             palloc_free_page(f->kaddr);
-            free(f);
+            kmem_cache_free(frame_cache, f);
 
             lock_release(&lru_list_lock);
             return;
@@ -83,6 +99,79 @@ ffree(void *kpage) {
     printf("ffree: The frame does not exsist.");
 }
 
+/* Waits until reclaim_lent() is not evicting SPTE's page.  Must
+   be called with lru_list_lock held. */
+static void
+wait_evicted (struct spt_entry *spte)
+{
+  ASSERT (lock_held_by_current_thread(&lru_list_lock));
+
+  while (spte->evicting)
+    cond_wait(&evict_done, &lru_list_lock);
+}
+
+/* Waits until SPTE's page is not being evicted, so that SPTE
+   says where the page's contents are. */
+void
+frame_wait (struct spt_entry *spte)
+{
+  lock_acquire(&lru_list_lock);
+  wait_evicted(spte);
+  lock_release(&lru_list_lock);
+}
+
+/* Pins SPTE's page, so that reclaim_lent() does not evict it,
+   waiting first for any eviction that is under way. */
+void
+frame_pin (struct spt_entry *spte)
+{
+  lock_acquire(&lru_list_lock);
+  wait_evicted(spte);
+  spte->pinned = true;
+  lock_release(&lru_list_lock);
+}
+
+/* Unpins SPTE's page. */
+void
+frame_unpin (struct spt_entry *spte)
+{
+  lock_acquire(&lru_list_lock);
+  spte->pinned = false;
+  lock_release(&lru_list_lock);
+}
+
+/* Unmaps SPTE's page from the running process and frees its
+   frame, if it is loaded, so that SPTE can be freed.  Waits
+   first for any eviction of the page to finish. */
+void
+frame_release (struct spt_entry *spte)
+{
+  struct list_elem *e;
+
+  lock_acquire(&lru_list_lock);
+  wait_evicted(spte);
+  if (spte->is_loaded && spte->kpage != NULL)
+    {
+      for (e = list_begin(&lru_list); e != list_end(&lru_list); e = list_next(e))
+        {
+          struct frame *f = list_entry(e, struct frame, lru);
+          if (f->kaddr == spte->kpage)
+            {
+              if (lru_cursor == f)
+                lru_cursor = NULL;
+              list_remove(&f->lru);
+              kmem_cache_free(frame_cache, f);
+              break;
+            }
+        }
+      pagedir_clear_page(thread_current()->pagedir, spte->vaddr);
+      palloc_free_page(spte->kpage);
+      spte->is_loaded = false;
+      spte->kpage = NULL;
+    }
+  lock_release(&lru_list_lock);
+}
+
 /*
 void add_page_to_lru_list(struct page *page)
 {
@@ -133,4 +222,123 @@ lock_acquire(&lru_list_lock);
 
     ffree(victim->kaddr);
 
-}
\ No newline at end of file
+}
+
+/* Evicts one user page that palloc's shared pool lent out, so
+   that the kernel can have it back.  Called by palloc from a
+   worker thread.  Prefers a page that was not accessed since
+   the last pass, clearing accessed bits along the way.  Returns
+   false if no lent page can be evicted.
+
+   Dirty file-backed pages are skipped, because writing one back
+   takes the file system locks, which the page's owner may hold
+   while it waits for the eviction in frame_wait(): a read()
+   into an mmapped buffer, for example.  They are written back
+   when they are unmapped.
+
+   The page is marked as being evicted before lru_list_lock is
+   released.  Until the eviction finishes, its owner waits in
+   frame_wait(), frame_pin() or frame_release() before it faults
+   the page back in, pins it or frees it, so the owner's page
+   directory and the page's spt_entry stay valid. */
+static bool
+reclaim_lent (void)
+{
+  struct frame *victim;
+
+  while ((victim = pick_lent ()) != NULL)
+    if (evict_lent (victim))
+      return true;
+  return false;
+}
+
+/* Returns the lent page that reclaim_lent() should evict, marked
+   as being evicted and removed from the LRU list, or a null
+   pointer if there is none. */
+static struct frame *
+pick_lent (void)
+{
+  struct frame *victim = NULL;
+  struct list_elem *e;
+
+  lock_acquire(&lru_list_lock);
+  for (e = list_begin(&lru_list); e != list_end(&lru_list); e = list_next(e))
+    {
+      struct frame *f = list_entry(e, struct frame, lru);
+
+      if (f->spte == NULL || !f->spte->is_loaded || f->spte->pinned
+          || f->owner->pagedir == NULL || !palloc_lent(f->kaddr))
+        continue;
+      if (f->spte->type == VM_FILE
+          && pagedir_is_dirty(f->owner->pagedir, f->spte->vaddr))
+        continue;
+      victim = f;
+      if (!pagedir_is_accessed(f->owner->pagedir, f->spte->vaddr))
+        break;
+      pagedir_set_accessed(f->owner->pagedir, f->spte->vaddr, false);
+    }
+  if (victim != NULL)
+    {
+      victim->spte->evicting = true;
+      victim->spte->is_loaded = false;
+      if (lru_cursor == victim)
+        lru_cursor = NULL;
+      list_remove(&victim->lru);
+    }
+  lock_release(&lru_list_lock);
+  return victim;
+}
+
+/* Evicts VICTIM, which pick_lent() returned, and frees its
+   frame.  Returns false, leaving VICTIM mapped and back on the
+   LRU list, if it is a file-backed page that became dirty after
+   it was picked. */
+static bool
+evict_lent (struct frame *victim)
+{
+  struct spt_entry *spte = victim->spte;
+  uint32_t *pd = victim->owner->pagedir;
+  size_t swap_slot = 0;
+  bool dirty;
+
+  /* Unmap the page before reading its dirty bit, so that a write
+     by the owner either shows up in the bit or faults and waits
+     for the eviction. */
+  pagedir_clear_page(pd, spte->vaddr);
+  dirty = pagedir_is_dirty(pd, spte->vaddr);
+
+  if (spte->type == VM_FILE && dirty)
+    {
+      /* The page table that held the mapping is still there, so
+         putting it back cannot fail. */
+      bool mapped = pagedir_set_page(pd, spte->vaddr, victim->kaddr,
+                                     spte->writable);
+      ASSERT (mapped);
+      pagedir_set_dirty(pd, spte->vaddr, true);
+
+      lock_acquire(&lru_list_lock);
+      spte->is_loaded = true;
+      spte->evicting = false;
+      list_push_back(&lru_list, &victim->lru);
+      cond_broadcast(&evict_done, &lru_list_lock);
+      lock_release(&lru_list_lock);
+      return false;
+    }
+  if (spte->type != VM_FILE)
+    swap_slot = swap_out(victim->kaddr);
+
+  lock_acquire(&lru_list_lock);
+  if (spte->type != VM_FILE)
+    {
+      spte->type = VM_ANON;
+      spte->swap_slot = swap_slot;
+    }
+  spte->kpage = NULL;
+  spte->evicting = false;
+  cond_broadcast(&evict_done, &lru_list_lock);
+  lock_release(&lru_list_lock);
+
+  palloc_free_page(victim->kaddr);
+  kmem_cache_free(frame_cache, victim);
+  return true;
+}
@@ -10,6 +10,10 @@ struct frame
 
 struct frame *falloc(enum palloc_flags);
 void ffree(void *);
+void frame_wait(struct spt_entry *);
+void frame_pin(struct spt_entry *);
+void frame_unpin(struct spt_entry *);
+void frame_release(struct spt_entry *);
 //void free_frame_thread (struct thread *);
 //void __free_frame(struct frame *);
 
@@ -6,12 +6,28 @@
 #include "userprog/pagedir.h"
 #include "filesys/file.h"
 #include "threads/interrupt.h"
+#include "threads/slab.h"
 #include "lib/kernel/hash.h"
 
 static unsigned spt_hash_func (const struct hash_elem *, void * UNUSED);
 static bool spt_less_func (const struct hash_elem *, const struct hash_elem *, void * UNUSED);
 static void spt_destroy_func (struct hash_elem *, void * UNUSED);
 
+/* Cache of struct spt_entry. */
+static struct kmem_cache *spte_cache;
+
+void page_init (void)
+{
+    spte_cache = kmem_cache_create("spt_entry", sizeof(struct spt_entry), NULL);
+}
+
+/* Allocates an uninitialized spt_entry, to be freed by
+   delete_spte() or spt_destroy().  Returns NULL if memory is not
+   available. */
+struct spt_entry *alloc_spte (void)
+{
+    return kmem_cache_alloc(spte_cache);
+}
 
 void spt_init (struct hash *spt)
 {
@@ -49,15 +65,11 @@ spt_destroy_func(struct hash_elem *e, void *aux UNUSED)
     ASSERT (e != NULL);
     struct spt_entry *spte = hash_entry(e, struct spt_entry, elem);
 
-    if (spte->is_loaded && spte->kpage != NULL)
-    {
-        pagedir_clear_page(thread_current()->pagedir, spte->vaddr);
-        palloc_free_page(spte->kpage);
-    }
+    frame_release(spte);
 
     // free_page_vaddr(spte->vaddr);
     // swap_clear(spte->swap_slot);
-    free(spte);
+    kmem_cache_free(spte_cache, spte);
 }
 
 struct spt_entry* find_spte(void *vaddr)
@@ -104,15 +116,11 @@ bool delete_spte(struct hash *spt, struct spt_entry *spte)
         return false;
     }
 
-    if (spte->is_loaded && spte->kpage != NULL)
-    {
-        pagedir_clear_page(thread_current()->pagedir, spte->vaddr);
-        palloc_free_page(spte->kpage);
-    }
+    frame_release(spte);
     
     // free_page_vaddr(spte->vaddr);
     // swap_clear(spte->swap_slot);
-    free(spte);
+    kmem_cache_free(spte_cache, spte);
 
     return true;
 }
@@ -29,6 +29,7 @@ struct spt_entry
     bool writable;
     bool is_loaded; 
     bool pinned; 
+    bool evicting;
 
     struct file* file;
     struct list_elem mmap_elem;
@@ -41,9 +42,11 @@ struct spt_entry
     struct hash_elem elem; // linked to hash table (spt)
 };
 
+void page_init(void);
 void spt_init(struct hash *);
 void spt_destroy(struct hash *);
 
+struct spt_entry *alloc_spte(void);
 struct spt_entry* find_spte(void *vaddr);
 bool insert_spte(struct hash *, struct spt_entry *);
 bool delete_spte(struct hash *, struct spt_entry *);
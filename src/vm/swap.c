@@ -4,6 +4,7 @@
 #include "devices/block.h"
 #include "threads/vaddr.h"
 #include "threads/interrupt.h"
+#include "threads/trace.h"
 
 struct lock swap_lock;
 struct bitmap *swap_bitmap;
@@ -27,7 +28,7 @@ void swap_in(struct spt_entry *spte, void *kaddr)
     
     int i;
     int id = spte->swap_slot;
-    printf("swap_in called\n");
+    TRACE (TRACE_SWAP_IN, id, kaddr, 0);
     lock_acquire(&swap_lock);
     {
         if (id > bitmap_size(swap_bitmap) || id < 0)
@@ -56,12 +57,12 @@ size_t swap_out(void *kaddr)
 {
     int i;
     int id;
-    printf("swap_out called\n");
     lock_acquire(&swap_lock);
     {
         id = bitmap_scan_and_flip(swap_bitmap, 0, 1, true);
     }
     lock_release(&swap_lock);
+    TRACE (TRACE_SWAP_OUT, id, kaddr, 0);
 
     for (i = 0; i < SECTOR_NUM; ++i)
     {